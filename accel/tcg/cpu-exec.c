@@ -192,7 +192,7 @@ static bool tb_lookup_cmp(const void *p, const void *d)
     return false;
 }
 
-static TranslationBlock *tb_htable_lookup(CPUState *cpu, TCGTBCPUState s)
+TranslationBlock *tb_htable_lookup(CPUState *cpu, TCGTBCPUState s)
 {
     tb_page_addr_t phys_pc;
     struct tb_desc desc;
@@ -210,6 +210,34 @@ static TranslationBlock *tb_htable_lookup(CPUState *cpu, TCGTBCPUState s)
     return qht_lookup_custom(&tb_ctx.htable, &desc, h, tb_lookup_cmp);
 }
 
+static inline bool tb_jmp_cache_match(CPUJumpCacheEntry *e,
+                                      TranslationBlock *tb, TCGTBCPUState s)
+{
+    return (tb &&
+            e->pc == s.pc &&
+            tb->cs_base == s.cs_base &&
+            tb->flags == s.flags &&
+            tb_cflags(tb) == s.cflags);
+}
+
+/*
+ * Install @tb for @pc in the first way of @jc, moving the entry it
+ * replaces to the victim way.  A stale entry may be moved while
+ * it is being invalidated, but it carries CF_INVALID and won't match.
+ */
+static void tb_jmp_cache_insert(CPUJumpCache *jc, uint32_t hash,
+                                vaddr pc, TranslationBlock *tb)
+{
+    TranslationBlock *old = qatomic_read(&jc->array[hash].tb);
+
+    if (old) {
+        jc->victim[hash].pc = jc->array[hash].pc;
+        qatomic_set(&jc->victim[hash].tb, old);
+    }
+    jc->array[hash].pc = pc;
+    qatomic_set(&jc->array[hash].tb, tb);
+}
+
 /**
  * tb_lookup:
  * @cpu: CPU that will execute the returned translation block
@@ -237,21 +265,24 @@ static inline TranslationBlock *tb_lookup(CPUState *cpu, TCGTBCPUState s)
     jc = cpu->tb_jmp_cache;
 
     tb = qatomic_read(&jc->array[hash].tb);
-    if (likely(tb &&
-               jc->array[hash].pc == s.pc &&
-               tb->cs_base == s.cs_base &&
-               tb->flags == s.flags &&
-               tb_cflags(tb) == s.cflags)) {
+    if (likely(tb_jmp_cache_match(&jc->array[hash], tb, s))) {
         goto hit;
     }
 
+    tb = qatomic_read(&jc->victim[hash].tb);
+    if (tb_jmp_cache_match(&jc->victim[hash], tb, s)) {
+        qatomic_set(&jc->victim_hit_count, jc->victim_hit_count + 1);
+        goto fill;
+    }
+
+    qatomic_set(&jc->miss_count, jc->miss_count + 1);
     tb = tb_htable_lookup(cpu, s);
     if (tb == NULL) {
         return NULL;
     }
 
-    jc->array[hash].pc = s.pc;
-    qatomic_set(&jc->array[hash].tb, tb);
+fill:
+    tb_jmp_cache_insert(jc, hash, s.pc, tb);
 
 hit:
     /*
@@ -963,9 +994,6 @@ cpu_exec_loop(CPUState *cpu, SyncClocks *sc)
 
             tb = tb_lookup(cpu, s);
             if (tb == NULL) {
-                CPUJumpCache *jc;
-                uint32_t h;
-
                 mmap_lock();
                 tb = tb_gen_code(cpu, s);
                 mmap_unlock();
@@ -974,10 +1002,8 @@ cpu_exec_loop(CPUState *cpu, SyncClocks *sc)
                  * We add the TB in the virtual pc hash table
                  * for the fast lookup
                  */
-                h = tb_jmp_cache_hash_func(s.pc);
-                jc = cpu->tb_jmp_cache;
-                jc->array[h].pc = s.pc;
-                qatomic_set(&jc->array[h].tb, tb);
+                tb_jmp_cache_insert(cpu->tb_jmp_cache,
+                                    tb_jmp_cache_hash_func(s.pc), s.pc, tb);
             }
 
 #ifndef CONFIG_USER_ONLY
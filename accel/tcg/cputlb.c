@@ -158,6 +158,7 @@ static void tb_jmp_cache_clear_page(CPUState *cpu, vaddr page_addr)
     i0 = tb_jmp_cache_hash_page(page_addr);
     for (i = 0; i < TB_JMP_PAGE_SIZE; i++) {
         qatomic_set(&jc->array[i0 + i].tb, NULL);
+        qatomic_set(&jc->victim[i0 + i].tb, NULL);
     }
 }
 
@@ -327,6 +328,9 @@ void tlb_init(CPUState *cpu)
 
     /* All tlbs are initialized flushed. */
     cpu->neg.tlb.c.dirty = 0;
+    cpu->neg.tlb.c.pending_queued = false;
+    cpu->neg.tlb.c.n_pending = 0;
+    cpu->neg.tlb.c.pending_full = 0;
 
     for (i = 0; i < NB_MMU_MODES; i++) {
         tlb_mmu_init(&cpu->neg.tlb.d[i], cpu_tlb_fast(cpu, i), now);
@@ -347,21 +351,53 @@ void tlb_destroy(CPUState *cpu)
     }
 }
 
-/* flush_all_helper: run fn across all cpus
+static void tlb_flush_pending_async_work(CPUState *cpu, run_on_cpu_data data);
+
+/*
+ * Queue the flush @req on @cpu on behalf of another cpu.
  *
- * If the wait flag is set then the src cpu's helper will be queued as
- * "safe" work and the loop exited creating a synchronisation point
- * where all queued work will be finished before execution starts
- * again.
+ * Rather than one work item per request, requests are accumulated in
+ * the target's pending list and performed together by the first work
+ * item queued, which the target runs at its next exit from the
+ * execution loop.  Guests issuing many remote flushes in a row, e.g.
+ * during munmap or mprotect, thus cost each target a single exit.
  */
-static void flush_all_helper(CPUState *src, run_on_cpu_func fn,
-                             run_on_cpu_data d)
+static void tlb_flush_pending_add(CPUState *cpu, const CPUTLBPendingFlush *req)
+{
+    CPUTLBCommon *c = &cpu->neg.tlb.c;
+    bool queue;
+
+    qemu_spin_lock(&c->lock);
+    if ((c->pending_full & req->idxmap) == req->idxmap) {
+        /* Already covered by a pending full flush. */
+    } else if (req->bits < TARGET_PAGE_BITS ||
+               c->n_pending == CPU_TLB_PENDING_SIZE) {
+        c->pending_full |= req->idxmap;
+    } else {
+        c->pending[c->n_pending++] = *req;
+    }
+    queue = !c->pending_queued;
+    if (queue) {
+        c->pending_queued = true;
+    } else {
+        qatomic_set(&c->coalesced_flush_count, c->coalesced_flush_count + 1);
+    }
+    qemu_spin_unlock(&c->lock);
+
+    if (queue) {
+        async_run_on_cpu(cpu, tlb_flush_pending_async_work, RUN_ON_CPU_NULL);
+    }
+}
+
+/* Queue @req on all cpus except @src. */
+static void tlb_flush_pending_add_all(CPUState *src,
+                                      const CPUTLBPendingFlush *req)
 {
     CPUState *cpu;
 
     CPU_FOREACH(cpu) {
         if (cpu != src) {
-            async_run_on_cpu(cpu, fn, d);
+            tlb_flush_pending_add(cpu, req);
         }
     }
 }
@@ -423,10 +459,11 @@ void tlb_flush(CPUState *cpu)
 void tlb_flush_by_mmuidx_all_cpus_synced(CPUState *src_cpu, MMUIdxMap idxmap)
 {
     const run_on_cpu_func fn = tlb_flush_by_mmuidx_async_work;
+    CPUTLBPendingFlush req = { .idxmap = idxmap };
 
     tlb_debug("mmu_idx: 0x%"PRIx16"\n", idxmap);
 
-    flush_all_helper(src_cpu, fn, RUN_ON_CPU_HOST_INT(idxmap));
+    tlb_flush_pending_add_all(src_cpu, &req);
     async_safe_run_on_cpu(src_cpu, fn, RUN_ON_CPU_HOST_INT(idxmap));
 }
 
@@ -499,6 +536,68 @@ static inline void tlb_flush_vtlb_page_locked(CPUState *cpu, int mmu_idx,
     tlb_flush_vtlb_page_mask_locked(cpu, mmu_idx, page, -1);
 }
 
+/*
+ * Flush @tlb_entry if any of its comparators in use lies within the
+ * region described by @page and @mask.  Unlike tlb_hit_page_mask_anyprot,
+ * unused (-1) comparators never match: a large page region in the upper
+ * half of a 64-bit address space, e.g. 0xffff800000000000, contains -1.
+ * Called with tlb_c.lock held.
+ */
+static bool tlb_flush_entry_region_locked(CPUTLBEntry *tlb_entry,
+                                          vaddr page, vaddr mask)
+{
+    vaddr cmp[3] = {
+        tlb_entry->addr_read,
+        tlb_addr_write(tlb_entry),
+        tlb_entry->addr_code,
+    };
+    int i;
+
+    page &= mask;
+    mask &= TARGET_PAGE_MASK | TLB_INVALID_MASK;
+
+    for (i = 0; i < ARRAY_SIZE(cmp); i++) {
+        if (cmp[i] != -1 && (cmp[i] & mask) == page) {
+            memset(tlb_entry, -1, sizeof(*tlb_entry));
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Flush all entries within the large page region of @midx, and forget
+ * the region.  Entries outside of the region are kept, which is why we
+ * prefer this over a flush of the entire mmu_idx: the region only covers
+ * the large pages, and the rest of the working set need not be refilled.
+ * Called with tlb_c.lock held.
+ */
+static void tlb_flush_large_page_locked(CPUState *cpu, int midx)
+{
+    CPUTLBDesc *d = &cpu->neg.tlb.d[midx];
+    CPUTLBDescFast *f = cpu_tlb_fast(cpu, midx);
+    vaddr lp_addr = d->large_page_addr;
+    vaddr lp_mask = d->large_page_mask;
+    unsigned int i, n = tlb_n_entries(f);
+
+    tlb_debug("flushing large pages midx %d (%016"
+              VADDR_PRIx "/%016" VADDR_PRIx ")\n",
+              midx, lp_addr, lp_mask);
+
+    for (i = 0; i < n; i++) {
+        if (tlb_flush_entry_region_locked(&f->table[i], lp_addr, lp_mask)) {
+            tlb_n_used_entries_dec(cpu, midx);
+        }
+    }
+    /* Victim entries are not counted in n_used_entries. */
+    for (i = 0; i < CPU_VTLB_SIZE; i++) {
+        tlb_flush_entry_region_locked(&d->vtable[i], lp_addr, lp_mask);
+    }
+
+    d->large_page_addr = -1;
+    d->large_page_mask = -1;
+}
+
 static void tlb_flush_page_locked(CPUState *cpu, int midx, vaddr page)
 {
     vaddr lp_addr = cpu->neg.tlb.d[midx].large_page_addr;
@@ -506,10 +605,7 @@ static void tlb_flush_page_locked(CPUState *cpu, int midx, vaddr page)
 
     /* Check if we need to flush due to large pages.  */
     if ((page & lp_mask) == lp_addr) {
-        tlb_debug("forcing full flush midx %d (%016"
-                  VADDR_PRIx "/%016" VADDR_PRIx ")\n",
-                  midx, lp_addr, lp_mask);
-        tlb_flush_one_mmuidx_locked(cpu, midx, get_clock_realtime());
+        tlb_flush_large_page_locked(cpu, midx);
     } else {
         if (tlb_flush_entry_locked(tlb_entry(cpu, midx, page), page)) {
             tlb_n_used_entries_dec(cpu, midx);
@@ -618,35 +714,29 @@ void tlb_flush_page_by_mmuidx_all_cpus_synced(CPUState *src_cpu,
                                               vaddr addr,
                                               MMUIdxMap idxmap)
 {
+    CPUTLBPendingFlush req;
+
     tlb_debug("addr: %016" VADDR_PRIx " mmu_idx:%"PRIx16"\n", addr, idxmap);
 
     /* This should already be page aligned */
     addr &= TARGET_PAGE_MASK;
 
+    req.addr = addr;
+    req.len = TARGET_PAGE_SIZE;
+    req.idxmap = idxmap;
+    req.bits = target_long_bits();
+    tlb_flush_pending_add_all(src_cpu, &req);
+
     /*
      * Allocate memory to hold addr+idxmap only when needed.
      * See tlb_flush_page_by_mmuidx for details.
      */
     if (idxmap < TARGET_PAGE_SIZE) {
-        flush_all_helper(src_cpu, tlb_flush_page_by_mmuidx_async_1,
-                         RUN_ON_CPU_TARGET_PTR(addr | idxmap));
         async_safe_run_on_cpu(src_cpu, tlb_flush_page_by_mmuidx_async_1,
                               RUN_ON_CPU_TARGET_PTR(addr | idxmap));
     } else {
-        CPUState *dst_cpu;
         TLBFlushPageByMMUIdxData *d;
 
-        /* Allocate a separate data block for each destination cpu.  */
-        CPU_FOREACH(dst_cpu) {
-            if (dst_cpu != src_cpu) {
-                d = g_new(TLBFlushPageByMMUIdxData, 1);
-                d->addr = addr;
-                d->idxmap = idxmap;
-                async_run_on_cpu(dst_cpu, tlb_flush_page_by_mmuidx_async_2,
-                                 RUN_ON_CPU_HOST_PTR(d));
-            }
-        }
-
         d = g_new(TLBFlushPageByMMUIdxData, 1);
         d->addr = addr;
         d->idxmap = idxmap;
@@ -690,13 +780,11 @@ static void tlb_flush_range_locked(CPUState *cpu, int midx,
      * Check if we need to flush due to large pages.
      * Because large_page_mask contains all 1's from the msb,
      * we only need to test the end of the range.
+     * The rest of the range may lie outside of the large page
+     * region, so continue with the page by page flush below.
      */
     if (((addr + len - 1) & d->large_page_mask) == d->large_page_addr) {
-        tlb_debug("forcing full flush midx %d ("
-                  "%016" VADDR_PRIx "/%016" VADDR_PRIx ")\n",
-                  midx, d->large_page_addr, d->large_page_mask);
-        tlb_flush_one_mmuidx_locked(cpu, midx, get_clock_realtime());
-        return;
+        tlb_flush_large_page_locked(cpu, midx);
     }
 
     for (vaddr i = 0; i < len; i += TARGET_PAGE_SIZE) {
@@ -710,12 +798,7 @@ static void tlb_flush_range_locked(CPUState *cpu, int midx,
     }
 }
 
-typedef struct {
-    vaddr addr;
-    vaddr len;
-    MMUIdxMap idxmap;
-    unsigned bits;
-} TLBFlushRangeData;
+typedef CPUTLBPendingFlush TLBFlushRangeData;
 
 static void tlb_flush_range_by_mmuidx_async_0(CPUState *cpu,
                                               TLBFlushRangeData d)
@@ -763,6 +846,47 @@ static void tlb_flush_range_by_mmuidx_async_1(CPUState *cpu,
     g_free(d);
 }
 
+/* Perform all of the flushes queued by tlb_flush_pending_add. */
+static void tlb_flush_pending_async_work(CPUState *cpu, run_on_cpu_data data)
+{
+    CPUTLBCommon *c = &cpu->neg.tlb.c;
+    TLBFlushRangeData pending[CPU_TLB_PENDING_SIZE];
+    MMUIdxMap full;
+    unsigned i, n;
+
+    assert_cpu_is_self(cpu);
+
+    /*
+     * Take the whole list at once; requests arriving after this
+     * point queue a new work item.
+     */
+    qemu_spin_lock(&c->lock);
+    full = c->pending_full;
+    n = c->n_pending;
+    memcpy(pending, c->pending, n * sizeof(pending[0]));
+    c->pending_full = 0;
+    c->n_pending = 0;
+    c->pending_queued = false;
+    qemu_spin_unlock(&c->lock);
+
+    if (full) {
+        tlb_flush_by_mmuidx_async_work(cpu, RUN_ON_CPU_HOST_INT(full));
+    }
+    for (i = 0; i < n; i++) {
+        TLBFlushRangeData d = pending[i];
+
+        d.idxmap &= ~full;
+        if (d.idxmap == 0) {
+            continue;
+        }
+        if (d.len <= TARGET_PAGE_SIZE && d.bits >= target_long_bits()) {
+            tlb_flush_page_by_mmuidx_async_0(cpu, d.addr, d.idxmap);
+        } else {
+            tlb_flush_range_by_mmuidx_async_0(cpu, d);
+        }
+    }
+}
+
 void tlb_flush_range_by_mmuidx(CPUState *cpu, vaddr addr,
                                vaddr len, MMUIdxMap idxmap,
                                unsigned bits)
@@ -807,7 +931,6 @@ void tlb_flush_range_by_mmuidx_all_cpus_synced(CPUState *src_cpu,
                                                unsigned bits)
 {
     TLBFlushRangeData d, *p;
-    CPUState *dst_cpu;
 
     /* If no page bits are significant, this devolves to tlb_flush. */
     if (bits < TARGET_PAGE_BITS) {
@@ -829,14 +952,7 @@ void tlb_flush_range_by_mmuidx_all_cpus_synced(CPUState *src_cpu,
     d.idxmap = idxmap;
     d.bits = bits;
 
-    /* Allocate a separate data block for each destination cpu.  */
-    CPU_FOREACH(dst_cpu) {
-        if (dst_cpu != src_cpu) {
-            p = g_memdup(&d, sizeof(d));
-            async_run_on_cpu(dst_cpu, tlb_flush_range_by_mmuidx_async_1,
-                             RUN_ON_CPU_HOST_PTR(p));
-        }
-    }
+    tlb_flush_pending_add_all(src_cpu, &d);
 
     p = g_memdup(&d, sizeof(d));
     async_safe_run_on_cpu(src_cpu, tlb_flush_range_by_mmuidx_async_1,
@@ -917,10 +1033,16 @@ static inline void copy_tlb_helper_locked(CPUTLBEntry *d, const CPUTLBEntry *s)
  */
 void tlb_reset_dirty(CPUState *cpu, uintptr_t start, uintptr_t length)
 {
-    int mmu_idx;
+    MMUIdxMap work;
 
     qemu_spin_lock(&cpu->neg.tlb.c.lock);
-    for (mmu_idx = 0; mmu_idx < NB_MMU_MODES; mmu_idx++) {
+    /*
+     * This runs against every cpu each time a page first gets translated
+     * code.  Only mmu indexes modified since their last flush can hold
+     * an entry for the page; skip walking the others.
+     */
+    for (work = cpu->neg.tlb.c.dirty; work != 0; work &= work - 1) {
+        int mmu_idx = ctz32(work);
         CPUTLBDesc *desc = &cpu->neg.tlb.d[mmu_idx];
         CPUTLBDescFast *fast = cpu_tlb_fast(cpu, mmu_idx);
         unsigned int n = tlb_n_entries(fast);
@@ -23,7 +23,16 @@
 #include "qemu/thread.h"
 #include "qemu/qht.h"
 
+#ifdef CONFIG_USER_ONLY
+/*
+ * User-mode processes are frequently short-lived and translate little
+ * code; start with a small table and let qht grow it on demand, rather
+ * than initializing half a megabyte of buckets on every startup.
+ */
+#define CODE_GEN_HTABLE_BITS     12
+#else
 #define CODE_GEN_HTABLE_BITS     15
+#endif
 #define CODE_GEN_HTABLE_SIZE     (1 << CODE_GEN_HTABLE_BITS)
 
 typedef struct TBContext TBContext;
@@ -22,12 +22,23 @@
  * non-NULL value of 'tb'.  Strictly speaking pc is only needed for
  * CF_PCREL, but it's used always for simplicity.
  */
+typedef struct CPUJumpCacheEntry {
+    TranslationBlock *tb;
+    vaddr pc;
+} CPUJumpCacheEntry;
+
+/*
+ * The cache is two-way set associative: an entry displaced from 'array'
+ * moves to the same index of 'victim', and is moved back on a hit there.
+ * Both ways use the same hash, so invalidation treats them alike.
+ */
 typedef struct CPUJumpCache {
     struct rcu_head rcu;
-    struct {
-        TranslationBlock *tb;
-        vaddr pc;
-    } array[TB_JMP_CACHE_SIZE];
+    CPUJumpCacheEntry array[TB_JMP_CACHE_SIZE];
+    CPUJumpCacheEntry victim[TB_JMP_CACHE_SIZE];
+    /* Statistics, only updated by the owning CPU. */
+    size_t victim_hit_count;
+    size_t miss_count;
 } CPUJumpCache;
 
 #endif /* ACCEL_TCG_TB_JMP_CACHE_H */
@@ -314,6 +314,8 @@ struct page_entry {
 struct page_collection {
     QTree *tree;
     struct page_entry *max;
+    /* Used instead of @tree when a single page needed locking. */
+    PageDesc *single;
 };
 
 typedef int PageForEachNext;
@@ -600,6 +602,40 @@ static gint tb_page_addr_cmp(gconstpointer ap, gconstpointer bp, gpointer udata)
     return 1;
 }
 
+/*
+ * Fast path for page_collection_lock: when the range lies within the
+ * page @index and none of the TBs on that page spans a second page,
+ * the lock of that page is all we need.  This is the common case for
+ * guest stores to code pages, and it needs neither a tree nor trylock
+ * retries.  Returns false, with no locks held, otherwise.
+ */
+static bool page_collection_lock_single(struct page_collection *set,
+                                        tb_page_addr_t index)
+{
+    TranslationBlock *tb;
+    PageForEachNext n;
+    PageDesc *pd;
+
+    pd = page_find(index);
+    if (pd == NULL) {
+        return true;
+    }
+
+    page_lock(pd);
+    PAGE_FOR_EACH_TB(unused, unused, pd, tb, n) {
+        tb_page_addr_t page1 = tb_page_addr1(tb);
+
+        if (page1 != -1 &&
+            (page1 >> TARGET_PAGE_BITS) !=
+            (tb_page_addr0(tb) >> TARGET_PAGE_BITS)) {
+            page_unlock(pd);
+            return false;
+        }
+    }
+    set->single = pd;
+    return true;
+}
+
 /*
  * Lock a range of pages ([@start,@last]) as well as the pages of all
  * intersecting TBs.
@@ -616,11 +652,18 @@ static struct page_collection *page_collection_lock(tb_page_addr_t start,
     last >>= TARGET_PAGE_BITS;
     g_assert(start <= last);
 
-    set->tree = q_tree_new_full(tb_page_addr_cmp, NULL, NULL,
-                                page_entry_destroy);
+    set->tree = NULL;
     set->max = NULL;
+    set->single = NULL;
     assert_no_pages_locked();
 
+    if (start == last && page_collection_lock_single(set, start)) {
+        return set;
+    }
+
+    set->tree = q_tree_new_full(tb_page_addr_cmp, NULL, NULL,
+                                page_entry_destroy);
+
  retry:
     q_tree_foreach(set->tree, page_entry_lock, NULL);
 
@@ -652,8 +695,12 @@ static struct page_collection *page_collection_lock(tb_page_addr_t start,
 
 static void page_collection_unlock(struct page_collection *set)
 {
-    /* entries are unlocked and freed via page_entry_destroy */
-    q_tree_destroy(set->tree);
+    if (set->tree) {
+        /* entries are unlocked and freed via page_entry_destroy */
+        q_tree_destroy(set->tree);
+    } else if (set->single) {
+        page_unlock(set->single);
+    }
     g_free(set);
 }
 
@@ -909,6 +956,9 @@ static void tb_jmp_cache_inval_tb(TranslationBlock *tb)
             if (qatomic_read(&jc->array[h].tb) == tb) {
                 qatomic_set(&jc->array[h].tb, NULL);
             }
+            if (qatomic_read(&jc->victim[h].tb) == tb) {
+                qatomic_set(&jc->victim[h].tb, NULL);
+            }
         }
     }
 }
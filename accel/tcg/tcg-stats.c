@@ -16,6 +16,7 @@
 #include "tcg/tcg.h"
 #include "internal-common.h"
 #include "tb-context.h"
+#include "tb-jmp-cache.h"
 #include <math.h>
 
 static void dump_drift_info(GString *buf)
@@ -132,34 +133,76 @@ static gboolean tb_tree_stats_iter(gpointer key, gpointer value, gpointer data)
     return false;
 }
 
-static void tlb_flush_counts(size_t *pfull, size_t *ppart, size_t *pelide)
+static void tlb_flush_counts(size_t *pfull, size_t *ppart, size_t *pelide,
+                             size_t *pcoalesced)
 {
     CPUState *cpu;
-    size_t full = 0, part = 0, elide = 0;
+    size_t full = 0, part = 0, elide = 0, coalesced = 0;
 
     CPU_FOREACH(cpu) {
         full += qatomic_read(&cpu->neg.tlb.c.full_flush_count);
         part += qatomic_read(&cpu->neg.tlb.c.part_flush_count);
         elide += qatomic_read(&cpu->neg.tlb.c.elide_flush_count);
+        coalesced += qatomic_read(&cpu->neg.tlb.c.coalesced_flush_count);
     }
     *pfull = full;
     *ppart = part;
     *pelide = elide;
+    *pcoalesced = coalesced;
+}
+
+static void tb_jmp_cache_counts(size_t *pvictim, size_t *pmiss)
+{
+    CPUState *cpu;
+    size_t victim = 0, miss = 0;
+
+    CPU_FOREACH(cpu) {
+        CPUJumpCache *jc = cpu->tb_jmp_cache;
+
+        if (jc) {
+            victim += qatomic_read(&jc->victim_hit_count);
+            miss += qatomic_read(&jc->miss_count);
+        }
+    }
+    *pvictim = victim;
+    *pmiss = miss;
 }
 
 static void tcg_dump_flush_info(GString *buf)
 {
-    size_t flush_full, flush_part, flush_elide;
+    size_t flush_full, flush_part, flush_elide, flush_coalesced;
+    size_t jc_victim, jc_miss;
+    size_t excl_sections, excl_kicks;
 
     g_string_append_printf(buf, "TB flush count      %u\n",
                            qatomic_read(&tb_ctx.tb_flush_count));
     g_string_append_printf(buf, "TB invalidate count %u\n",
                            qatomic_read(&tb_ctx.tb_phys_invalidate_count));
 
-    tlb_flush_counts(&flush_full, &flush_part, &flush_elide);
+    tlb_flush_counts(&flush_full, &flush_part, &flush_elide, &flush_coalesced);
     g_string_append_printf(buf, "TLB full flushes    %zu\n", flush_full);
     g_string_append_printf(buf, "TLB partial flushes %zu\n", flush_part);
     g_string_append_printf(buf, "TLB elided flushes  %zu\n", flush_elide);
+    g_string_append_printf(buf, "TLB merged flushes  %zu\n", flush_coalesced);
+
+    tb_jmp_cache_counts(&jc_victim, &jc_miss);
+    g_string_append_printf(buf, "TB jmp victim hits  %zu\n", jc_victim);
+    g_string_append_printf(buf, "TB jmp cache misses %zu\n", jc_miss);
+
+    cpu_exclusive_stats(&excl_sections, &excl_kicks);
+    g_string_append_printf(buf, "Exclusive sections  %zu\n", excl_sections);
+    g_string_append_printf(buf, "Exclusive CPU kicks %zu\n", excl_kicks);
+}
+
+static void tcg_dump_optimize_info(GString *buf)
+{
+    size_t ops_in, ops_out, cse;
+
+    tcg_optimize_stats(&ops_in, &ops_out, &cse);
+    g_string_append_printf(buf, "TCG ops optimized   %zu -> %zu (%zu%%)\n",
+                           ops_in, ops_out,
+                           ops_in ? (ops_out * 100) / ops_in : 0);
+    g_string_append_printf(buf, "TCG ops CSE'd       %zu\n", cse);
 }
 
 static void dump_exec_info(GString *buf)
@@ -204,6 +247,7 @@ static void dump_exec_info(GString *buf)
 
     g_string_append_printf(buf, "\nStatistics:\n");
     tcg_dump_flush_info(buf);
+    tcg_dump_optimize_info(buf);
 }
 
 void tcg_get_stats(AccelState *accel, GString *buf)
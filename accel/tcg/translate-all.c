@@ -316,6 +316,31 @@ TranslationBlock *tb_gen_code(CPUState *cpu, TCGTBCPUState s)
     }
 
     tcg_ctx->gen_tb = tb;
+
+    /*
+     * Translation into a given page is serialized by the page lock
+     * (by mmap_lock for user-only).  If another cpu translated this
+     * very block while we were waiting for the lock, which is common
+     * while all cpus of an SMP guest run the same firmware and kernel
+     * code, reuse its work instead of translating it again.
+     * Note that tb_htable_lookup may raise an exception while probing
+     * the second page; gen_tb is already set so that the longjmp
+     * cleanup releases the page lock.
+     */
+    if (phys_pc != -1) {
+        existing_tb = tb_htable_lookup(cpu, s);
+        if (unlikely(existing_tb)) {
+            uintptr_t orig_aligned = (uintptr_t)gen_code_buf;
+
+            trace_tb_gen_code_reuse(existing_tb, s.pc);
+            tcg_ctx->gen_tb = NULL;
+            tb_unlock_pages(tb);
+            orig_aligned -= ROUND_UP(sizeof(*tb), qemu_icache_linesize);
+            qatomic_set(&tcg_ctx->code_gen_ptr, (void *)orig_aligned);
+            return existing_tb;
+        }
+    }
+
     tcg_ctx->addr_type = target_long_bits() == 32 ? TCG_TYPE_I32 : TCG_TYPE_I64;
     tcg_ctx->guest_mo = cpu->cc->tcg_ops->guest_default_memory_order;
 
@@ -636,5 +661,6 @@ void tcg_flush_jmp_cache(CPUState *cpu)
 
     for (int i = 0; i < TB_JMP_CACHE_SIZE; i++) {
         qatomic_set(&jc->array[i].tb, NULL);
+        qatomic_set(&jc->victim[i].tb, NULL);
     }
 }
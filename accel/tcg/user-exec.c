@@ -258,6 +258,21 @@ int page_get_flags(vaddr address)
     return p ? p->flags : 0;
 }
 
+int page_get_flags_range(vaddr start, vaddr last)
+{
+    PageFlagsNode *p;
+    int flags = 0;
+
+    assert(start <= last);
+    assert_memory_lock();
+
+    for (p = pageflags_find(start, last); p;
+         p = pageflags_next(p, start, last)) {
+        flags |= p->flags;
+    }
+    return flags;
+}
+
 /* A subroutine of page_set_flags: insert a new node for [start,last]. */
 static void pageflags_create(vaddr start, vaddr last, int flags)
 {
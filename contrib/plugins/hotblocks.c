@@ -18,11 +18,13 @@
 QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
 
 static bool do_inline;
+static bool do_folded;
 
 /* Plugins need to take care of their own locking */
 static GMutex lock;
 static GHashTable *hotblocks;
 static guint64 limit = 20;
+static bool limit_set;
 
 /*
  * Counting Structure
@@ -37,8 +39,14 @@ typedef struct {
     struct qemu_plugin_scoreboard *exec_count;
     int trans_count;
     unsigned long insns;
+    const char *symbol;
 } ExecCount;
 
+typedef struct {
+    const char *symbol;
+    uint64_t insns;
+} SymbolCount;
+
 static gint cmp_exec_count(gconstpointer a, gconstpointer b, gpointer d)
 {
     ExecCount *ea = (ExecCount *) a;
@@ -70,14 +78,68 @@ static void exec_count_free(gpointer key, gpointer value, gpointer user_data)
     qemu_plugin_scoreboard_free(cnt->exec_count);
 }
 
+static gint cmp_symbol_count(gconstpointer a, gconstpointer b)
+{
+    const SymbolCount *sa = a;
+    const SymbolCount *sb = b;
+    return sa->insns > sb->insns ? -1 : sa->insns < sb->insns;
+}
+
+/*
+ * Report executed instructions per guest symbol, one "symbol count" line
+ * each, as expected by flame graph tools for collapsed stacks.
+ */
+static void report_folded(GString *report)
+{
+    g_autoptr(GHashTable) symbols = g_hash_table_new_full(g_str_hash,
+                                                          g_str_equal,
+                                                          NULL, g_free);
+    GHashTableIter iter;
+    GList *counts, *it;
+    ExecCount *rec;
+    SymbolCount *sym;
+    guint64 max = limit_set ? limit : 0;
+    int i;
+
+    g_hash_table_iter_init(&iter, hotblocks);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &rec)) {
+        const char *name = rec->symbol ? rec->symbol : "[unknown]";
+
+        sym = g_hash_table_lookup(symbols, name);
+        if (!sym) {
+            sym = g_new0(SymbolCount, 1);
+            sym->symbol = name;
+            g_hash_table_insert(symbols, (gpointer) name, sym);
+        }
+        sym->insns += rec->insns *
+            qemu_plugin_u64_sum(qemu_plugin_scoreboard_u64(rec->exec_count));
+    }
+
+    counts = g_list_sort(g_hash_table_get_values(symbols), cmp_symbol_count);
+    for (i = 0, it = counts; (max == 0 || i < max) && it;
+         i++, it = it->next) {
+        sym = it->data;
+        g_string_append_printf(report, "%s %"PRIu64"\n",
+                               sym->symbol, sym->insns);
+    }
+    g_list_free(counts);
+}
+
 static void plugin_exit(qemu_plugin_id_t id, void *p)
 {
-    g_autoptr(GString) report = g_string_new("collected ");
+    g_autoptr(GString) report = g_string_new(NULL);
     GList *counts, *sorted_counts, *it;
     int i;
 
-    g_string_append_printf(report, "%d entries in the hash table\n",
+    /* Folded output must only contain "symbol count" lines */
+    if (do_folded) {
+        report_folded(report);
+        goto out;
+    }
+
+    g_string_append_printf(report, "collected %d entries in the hash table\n",
                            g_hash_table_size(hotblocks));
+
     counts = g_hash_table_get_values(hotblocks);
     sorted_counts = g_list_sort_with_data(counts, cmp_exec_count, NULL);
 
@@ -98,6 +160,7 @@ static void plugin_exit(qemu_plugin_id_t id, void *p)
         g_list_free(sorted_counts);
     }
 
+ out:
     qemu_plugin_outs(report->str);
 
     g_hash_table_foreach(hotblocks, exec_count_free, NULL);
@@ -142,6 +205,7 @@ static void vcpu_tb_trans(qemu_plugin_id_t id, struct qemu_plugin_tb *tb)
         cnt->start_addr = pc;
         cnt->trans_count = 1;
         cnt->insns = insns;
+        cnt->symbol = qemu_plugin_insn_symbol(qemu_plugin_tb_get_insn(tb, 0));
         cnt->exec_count = qemu_plugin_scoreboard_new(sizeof(uint64_t));
         g_hash_table_insert(hotblocks, cnt, cnt);
     }
@@ -171,6 +235,11 @@ int qemu_plugin_install(qemu_plugin_id_t id, const qemu_info_t *info,
                 fprintf(stderr, "boolean argument parsing failed: %s\n", opt);
                 return -1;
             }
+        } else if (g_strcmp0(tokens[0], "folded") == 0) {
+            if (!qemu_plugin_bool_parse(tokens[0], tokens[1], &do_folded)) {
+                fprintf(stderr, "boolean argument parsing failed: %s\n", opt);
+                return -1;
+            }
         } else if (g_strcmp0(tokens[0], "limit") == 0) {
             char *endptr = NULL;
             limit = g_ascii_strtoull(tokens[1], &endptr, 10);
@@ -178,6 +247,7 @@ int qemu_plugin_install(qemu_plugin_id_t id, const qemu_info_t *info,
                 fprintf(stderr, "unsigned integer parsing failed: %s\n", opt);
                 return -1;
             }
+            limit_set = true;
         } else {
             fprintf(stderr, "option parsing failed: %s\n", opt);
             return -1;
@@ -34,6 +34,10 @@ static QemuCond qemu_work_cond;
  */
 static int pending_cpus;
 
+/* Statistics, written under qemu_cpu_list_lock.  */
+static size_t exclusive_sections;
+static size_t exclusive_kicks;
+
 void qemu_init_cpu_list(void)
 {
     /* This is needed because qemu_init_cpu_list is also called by the
@@ -220,6 +224,8 @@ void start_exclusive(void)
     }
 
     qatomic_set(&pending_cpus, running_cpus + 1);
+    qatomic_set(&exclusive_sections, exclusive_sections + 1);
+    qatomic_set(&exclusive_kicks, exclusive_kicks + running_cpus);
     while (pending_cpus > 1) {
         qemu_cond_wait(&exclusive_cond, &qemu_cpu_list_lock);
     }
@@ -246,6 +252,12 @@ void end_exclusive(void)
     qemu_mutex_unlock(&qemu_cpu_list_lock);
 }
 
+void cpu_exclusive_stats(size_t *sections, size_t *kicks)
+{
+    *sections = qatomic_read(&exclusive_sections);
+    *kicks = qatomic_read(&exclusive_kicks);
+}
+
 /* Wait for exclusive ops to finish, and begin cpu execution.  */
 void cpu_exec_start(CPUState *cpu)
 {
@@ -352,6 +364,7 @@ void free_queued_cpu_work(CPUState *cpu)
 void process_queued_cpu_work(CPUState *cpu)
 {
     struct qemu_work_item *wi;
+    bool exclusive = false;
 
     qemu_mutex_lock(&cpu->work_mutex);
     if (QSIMPLEQ_EMPTY(&cpu->work_list)) {
@@ -368,13 +381,22 @@ void process_queued_cpu_work(CPUState *cpu)
              * CPU is running; 2) cpu_exec in the other CPU tries to takes the
              * BQL, so it goes to sleep; start_exclusive() is sleeping too, so
              * neither CPU can proceed.
+             *
+             * Consecutive exclusive items share one exclusive section, so
+             * that the other CPUs are only stopped once for the whole batch.
              */
-            bql_unlock();
-            start_exclusive();
+            if (!exclusive) {
+                bql_unlock();
+                start_exclusive();
+                exclusive = true;
+            }
             wi->func(cpu, wi->data);
-            end_exclusive();
-            bql_lock();
         } else {
+            if (exclusive) {
+                end_exclusive();
+                bql_lock();
+                exclusive = false;
+            }
             wi->func(cpu, wi->data);
         }
         qemu_mutex_lock(&cpu->work_mutex);
@@ -385,6 +407,10 @@ void process_queued_cpu_work(CPUState *cpu)
         }
     }
     qemu_mutex_unlock(&cpu->work_mutex);
+    if (exclusive) {
+        end_exclusive();
+        bql_lock();
+    }
     qemu_cond_broadcast(&qemu_work_cond);
 }
 
@@ -2905,6 +2905,24 @@ float32 float64_to_float32(float64 a, float_status *s)
 {
     FloatParts64 p;
 
+    if (likely(can_use_fpu(s) && float64_is_zero_or_normal(a))) {
+        union_float64 ud;
+        union_float32 uf;
+
+        /*
+         * Narrowing may be inexact, but inexact is already set.
+         * Leave overflow and anything that may be tiny to softfloat:
+         * the former may need rebiasing, and the detection of tininess
+         * is target dependent.
+         */
+        ud.s = a;
+        uf.h = ud.h;
+        if (likely((fabsf(uf.h) > FLT_MIN && !f32_is_inf(uf)) ||
+                   float64_is_zero(a))) {
+            return uf.s;
+        }
+    }
+
     float64_unpack_canonical(&p, a, s);
     parts_float_to_float(&p, s);
     return float32_round_pack_canonical(&p, s);
@@ -3070,6 +3088,18 @@ float32 float32_round_to_int(float32 a, float_status *s)
 {
     FloatParts64 p;
 
+    /*
+     * The host rounds to nearest even, and the result of rounding a
+     * normal number to an integer is exact apart from the inexact flag.
+     */
+    if (likely(can_use_fpu(s) && float32_is_zero_or_normal(a))) {
+        union_float32 ur;
+
+        ur.s = a;
+        ur.h = rintf(ur.h);
+        return ur.s;
+    }
+
     float32_unpack_canonical(&p, a, s);
     parts_round_to_int(&p, s->float_rounding_mode, 0, s, &float32_params);
     return float32_round_pack_canonical(&p, s);
@@ -3079,6 +3109,15 @@ float64 float64_round_to_int(float64 a, float_status *s)
 {
     FloatParts64 p;
 
+    /* See float32_round_to_int. */
+    if (likely(can_use_fpu(s) && float64_is_zero_or_normal(a))) {
+        union_float64 ur;
+
+        ur.s = a;
+        ur.h = rint(ur.h);
+        return ur.s;
+    }
+
     float64_unpack_canonical(&p, a, s);
     parts_round_to_int(&p, s->float_rounding_mode, 0, s, &float64_params);
     return float64_round_pack_canonical(&p, s);
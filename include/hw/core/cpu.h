@@ -212,6 +212,9 @@ typedef uint32_t MMUIdxMap;
 /* Use a fully associative victim tlb of 8 entries. */
 #define CPU_VTLB_SIZE 8
 
+/* Coalesce up to 16 flush requests from other cpus. */
+#define CPU_TLB_PENDING_SIZE 16
+
 /*
  * The full TLB entry, which is not accessed by generated TCG code,
  * so the layout is not as critical as that of CPUTLBEntry. This is
@@ -284,8 +287,8 @@ typedef struct CPUTLBDesc {
     /*
      * Describe a region covering all of the large pages allocated
      * into the tlb.  When any page within this region is flushed,
-     * we must flush the entire tlb.  The region is matched if
-     * (addr & large_page_mask) == large_page_addr.
+     * we must flush all entries within the region.  The region is
+     * matched if (addr & large_page_mask) == large_page_addr.
      */
     vaddr large_page_addr;
     vaddr large_page_mask;
@@ -302,6 +305,17 @@ typedef struct CPUTLBDesc {
     CPUTLBEntryFull *fulltlb;
 } CPUTLBDesc;
 
+/*
+ * A tlb flush requested by another cpu, not yet performed.
+ * If @bits is less than TARGET_PAGE_BITS, flush all of @idxmap.
+ */
+typedef struct CPUTLBPendingFlush {
+    vaddr addr;
+    vaddr len;
+    MMUIdxMap idxmap;
+    unsigned bits;
+} CPUTLBPendingFlush;
+
 /*
  * Data elements that are shared between all MMU modes.
  */
@@ -314,6 +328,17 @@ typedef struct CPUTLBCommon {
      * Protected by tlb_c.lock.
      */
     MMUIdxMap dirty;
+    /*
+     * Flushes requested by other cpus are accumulated here, and are all
+     * performed by a single work item queued by the first request.
+     * When @pending overflows, the mmu indexes of further requests are
+     * accumulated in @pending_full and flushed entirely.
+     * Protected by tlb_c.lock.
+     */
+    bool pending_queued;
+    unsigned n_pending;
+    MMUIdxMap pending_full;
+    CPUTLBPendingFlush pending[CPU_TLB_PENDING_SIZE];
     /*
      * Statistics.  These are not lock protected, but are read and
      * written atomically.  This allows the monitor to print a snapshot
@@ -322,6 +347,7 @@ typedef struct CPUTLBCommon {
     size_t full_flush_count;
     size_t part_flush_count;
     size_t elide_flush_count;
+    size_t coalesced_flush_count;
 } CPUTLBCommon;
 
 /*
@@ -1116,6 +1142,13 @@ void start_exclusive(void);
  */
 void end_exclusive(void);
 
+/**
+ * cpu_exclusive_stats:
+ * @sections: number of exclusive sections started so far
+ * @kicks: number of running CPUs that had to be stopped for them
+ */
+void cpu_exclusive_stats(size_t *sections, size_t *kicks);
+
 /**
  * qemu_init_vcpu:
  * @cpu: The vCPU to initialize.
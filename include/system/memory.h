@@ -1190,6 +1190,8 @@ struct AddressSpace {
     size_t max_bounce_buffer_size;
     /* Total size of bounce buffers currently allocated, atomically accessed */
     size_t bounce_buffer_size;
+    /* Most recently released bounce buffer, kept for reuse; atomic */
+    void *bounce_buffer_cache;
     /* List of callbacks to invoke when buffers free up */
     QemuMutex map_client_list_lock;
     QLIST_HEAD(, AddressSpaceMapClient) map_client_list;
@@ -45,6 +45,13 @@ struct RAMBlock {
     size_t page_size;
     /* dirty bitmap used during migration */
     unsigned long *bmap;
+    /*
+     * pages written during each of the last two dirty sync periods, and
+     * pages written during the last one; only allocated with the
+     * x-defer-hot-pages migration capability
+     */
+    unsigned long *hot_bmap;
+    unsigned long *warm_bmap;
 
     /*
      * Below fields are only used by mapped-ram migration
@@ -416,6 +416,11 @@ struct TCGContext {
      */
     bool carry_live;
 
+    /* Optimizer statistics; see tcg_optimize_stats(). */
+    size_t opt_ops_in;
+    size_t opt_ops_out;
+    size_t opt_cse_count;
+
     GHashTable *const_table[TCG_TYPE_COUNT];
     TCGTempSet free_temps[TCG_TYPE_COUNT];
     TCGTemp temps[TCG_MAX_TEMPS]; /* globals first, temps after */
@@ -631,6 +636,7 @@ void tcg_region_reset_all(void);
 
 size_t tcg_code_size(void);
 size_t tcg_code_capacity(void);
+void tcg_optimize_stats(size_t *ops_in, size_t *ops_out, size_t *cse);
 
 /**
  * tcg_tb_insert:
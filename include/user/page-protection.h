@@ -19,6 +19,17 @@ int page_unprotect(CPUState *cpu, tb_page_addr_t address, uintptr_t pc);
 
 int page_get_flags(vaddr address);
 
+/**
+ * page_get_flags_range:
+ * @start: first byte of range
+ * @last: last byte of range
+ * Context: holding mmap lock
+ *
+ * Return the union of the flags of all pages in the range,
+ * which is 0 if none of them is mapped.
+ */
+int page_get_flags_range(vaddr start, vaddr last);
+
 /**
  * page_set_flags:
  * @start: first byte of range
@@ -209,11 +209,11 @@ int target_mprotect(abi_ulong start, abi_ulong len, int target_prot)
     if (host_last - host_start < host_page_size) {
         /* Single host page contains all guest pages: sum the prot. */
         prot1 = target_prot;
-        for (abi_ulong a = host_start; a < start; a += TARGET_PAGE_SIZE) {
-            prot1 |= page_get_flags(a);
+        if (host_start < start) {
+            prot1 |= page_get_flags_range(host_start, start - 1);
         }
-        for (abi_ulong a = last; a < host_last; a += TARGET_PAGE_SIZE) {
-            prot1 |= page_get_flags(a + 1);
+        if (last < host_last) {
+            prot1 |= page_get_flags_range(last + 1, host_last);
         }
         starts[nranges] = host_start;
         lens[nranges] = host_page_size;
@@ -222,10 +222,7 @@ int target_mprotect(abi_ulong start, abi_ulong len, int target_prot)
     } else {
         if (host_start < start) {
             /* Host page contains more than one guest page: sum the prot. */
-            prot1 = target_prot;
-            for (abi_ulong a = host_start; a < start; a += TARGET_PAGE_SIZE) {
-                prot1 |= page_get_flags(a);
-            }
+            prot1 = target_prot | page_get_flags_range(host_start, start - 1);
             /* If the resulting sum differs, create a new range. */
             if (prot1 != target_prot) {
                 starts[nranges] = host_start;
@@ -238,10 +235,7 @@ int target_mprotect(abi_ulong start, abi_ulong len, int target_prot)
 
         if (last < host_last) {
             /* Host page contains more than one guest page: sum the prot. */
-            prot1 = target_prot;
-            for (abi_ulong a = last; a < host_last; a += TARGET_PAGE_SIZE) {
-                prot1 |= page_get_flags(a + 1);
-            }
+            prot1 = target_prot | page_get_flags_range(last + 1, host_last);
             /* If the resulting sum differs, create a new range. */
             if (prot1 != target_prot) {
                 host_last -= host_page_size;
@@ -361,11 +355,11 @@ static bool mmap_frag(abi_ulong real_start, abi_ulong start, abi_ulong last,
 
     /* Get the protection of the target pages outside the mapping. */
     prot_old = 0;
-    for (abi_ulong a = real_start; a < start; a += TARGET_PAGE_SIZE) {
-        prot_old |= page_get_flags(a);
+    if (real_start < start) {
+        prot_old |= page_get_flags_range(real_start, start - 1);
     }
-    for (abi_ulong a = real_last; a > last; a -= TARGET_PAGE_SIZE) {
-        prot_old |= page_get_flags(a);
+    if (last < real_last) {
+        prot_old |= page_get_flags_range(last + 1, real_last);
     }
 
     if (prot_old == 0) {
@@ -1025,7 +1019,6 @@ static int mmap_reserve_or_unmap(abi_ulong start, abi_ulong len)
     abi_ulong real_last;
     abi_ulong real_len;
     abi_ulong last;
-    abi_ulong a;
     void *host_start;
     int prot;
 
@@ -1041,27 +1034,22 @@ static int mmap_reserve_or_unmap(abi_ulong start, abi_ulong len)
      */
     if (real_last - real_start < host_page_size) {
         prot = 0;
-        for (a = real_start; a < start; a += TARGET_PAGE_SIZE) {
-            prot |= page_get_flags(a);
+        if (real_start < start) {
+            prot |= page_get_flags_range(real_start, start - 1);
         }
-        for (a = last; a < real_last; a += TARGET_PAGE_SIZE) {
-            prot |= page_get_flags(a + 1);
+        if (last < real_last) {
+            prot |= page_get_flags_range(last + 1, real_last);
         }
         if (prot != 0) {
             return 0;
         }
     } else {
-        for (prot = 0, a = real_start; a < start; a += TARGET_PAGE_SIZE) {
-            prot |= page_get_flags(a);
-        }
-        if (prot != 0) {
+        if (real_start < start &&
+            page_get_flags_range(real_start, start - 1) != 0) {
             real_start += host_page_size;
         }
-
-        for (prot = 0, a = last; a < real_last; a += TARGET_PAGE_SIZE) {
-            prot |= page_get_flags(a + 1);
-        }
-        if (prot != 0) {
+        if (last < real_last &&
+            page_get_flags_range(last + 1, real_last) != 0) {
             real_last -= host_page_size;
         }
 
@@ -1154,12 +1142,8 @@ abi_long target_mremap(abi_ulong old_addr, abi_ulong old_size,
     } else {
         int page_flags = 0;
         if (reserved_va && old_size < new_size) {
-            abi_ulong addr;
-            for (addr = old_addr + old_size;
-                 addr < old_addr + new_size;
-                 addr++) {
-                page_flags |= page_get_flags(addr);
-            }
+            page_flags = page_get_flags_range(old_addr + old_size,
+                                              old_addr + new_size - 1);
         }
         if (page_flags == 0) {
             host_addr = mremap(g2h_untagged(old_addr),
@@ -19,11 +19,20 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/iov.h"
+#include "qemu/units.h"
 #include "migration/channel-block.h"
 #include "qapi/error.h"
 #include "block/block.h"
 #include "trace.h"
 
+/*
+ * QEMUFile reads at most 32KiB at a time, and every vmstate read is a
+ * synchronous request to the block layer.  Read the vmstate in larger
+ * chunks and serve small reads from memory instead.
+ */
+#define QIO_CHANNEL_BLOCK_READAHEAD (1 * MiB)
+
 QIOChannelBlock *
 qio_channel_block_new(BlockDriverState *bs)
 {
@@ -45,6 +54,7 @@ qio_channel_block_finalize(Object *obj)
     QIOChannelBlock *ioc = QIO_CHANNEL_BLOCK(obj);
 
     g_clear_pointer(&ioc->bs, bdrv_unref);
+    g_free(ioc->rbuf);
 }
 
 
@@ -59,17 +69,42 @@ qio_channel_block_readv(QIOChannel *ioc,
 {
     QIOChannelBlock *bioc = QIO_CHANNEL_BLOCK(ioc);
     QEMUIOVector qiov;
+    size_t len = iov_size(iov, niov);
     int ret;
 
-    qemu_iovec_init_external(&qiov, (struct iovec *)iov, niov);
-    ret = bdrv_readv_vmstate(bioc->bs, &qiov, bioc->offset);
-    if (ret < 0) {
-        error_setg_errno(errp, -ret, "bdrv_readv_vmstate failed");
-        return -1;
+    if (len >= QIO_CHANNEL_BLOCK_READAHEAD) {
+        qemu_iovec_init_external(&qiov, (struct iovec *)iov, niov);
+        ret = bdrv_readv_vmstate(bioc->bs, &qiov, bioc->offset);
+        if (ret < 0) {
+            error_setg_errno(errp, -ret, "bdrv_readv_vmstate failed");
+            return -1;
+        }
+
+        bioc->offset += qiov.size;
+        return qiov.size;
     }
 
-    bioc->offset += qiov.size;
-    return qiov.size;
+    if (bioc->offset < bioc->rbuf_offset ||
+        bioc->offset >= bioc->rbuf_offset + bioc->rbuf_len) {
+        if (!bioc->rbuf) {
+            bioc->rbuf = g_malloc(QIO_CHANNEL_BLOCK_READAHEAD);
+        }
+        bioc->rbuf_len = 0;
+        qemu_iovec_init_buf(&qiov, bioc->rbuf, QIO_CHANNEL_BLOCK_READAHEAD);
+        ret = bdrv_readv_vmstate(bioc->bs, &qiov, bioc->offset);
+        if (ret < 0) {
+            error_setg_errno(errp, -ret, "bdrv_readv_vmstate failed");
+            return -1;
+        }
+        bioc->rbuf_offset = bioc->offset;
+        bioc->rbuf_len = QIO_CHANNEL_BLOCK_READAHEAD;
+    }
+
+    len = MIN(len, bioc->rbuf_offset + bioc->rbuf_len - bioc->offset);
+    len = iov_from_buf(iov, niov, 0,
+                       bioc->rbuf + (bioc->offset - bioc->rbuf_offset), len);
+    bioc->offset += len;
+    return len;
 }
 
 
@@ -86,6 +121,7 @@ qio_channel_block_writev(QIOChannel *ioc,
     QEMUIOVector qiov;
     int ret;
 
+    bioc->rbuf_len = 0;
     qemu_iovec_init_external(&qiov, (struct iovec *)iov, niov);
     ret = bdrv_writev_vmstate(bioc->bs, &qiov, bioc->offset);
     if (ret < 0) {
@@ -129,6 +165,7 @@ qio_channel_block_pwritev(QIOChannel *ioc,
     QEMUIOVector qiov;
     int ret;
 
+    bioc->rbuf_len = 0;
     qemu_iovec_init_external(&qiov, (struct iovec *)iov, niov);
     ret = bdrv_writev_vmstate(bioc->bs, &qiov, offset);
     if (ret < 0) {
@@ -192,6 +229,8 @@ qio_channel_block_close(QIOChannel *ioc,
     }
 
     g_clear_pointer(&bioc->bs, bdrv_unref);
+    g_clear_pointer(&bioc->rbuf, g_free);
+    bioc->rbuf_len = 0;
     bioc->offset = 0;
 
     return 0;
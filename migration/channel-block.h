@@ -40,6 +40,10 @@ struct QIOChannelBlock {
     QIOChannel parent;
     BlockDriverState *bs;
     off_t offset;
+    /* Read-ahead buffer, holding [rbuf_offset, rbuf_offset + rbuf_len) */
+    uint8_t *rbuf;
+    off_t rbuf_offset;
+    size_t rbuf_len;
 };
 
 
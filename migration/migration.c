@@ -82,6 +82,8 @@ enum mig_rp_message_type {
     MIG_RP_MSG_RECV_BITMAP,  /* send recved_bitmap back to source */
     MIG_RP_MSG_RESUME_ACK,   /* tell source that we are ready to resume */
     MIG_RP_MSG_SWITCHOVER_ACK, /* Tell source it's OK to do switchover */
+    /* Pages expected soon, data (start: be64, len: be32, id: string) */
+    MIG_RP_MSG_REQ_PAGES_AHEAD,
 
     MIG_RP_MSG_MAX
 };
@@ -526,17 +528,17 @@ static int migrate_send_rp_message(MigrationIncomingState *mis,
     return qemu_fflush(mis->to_src_file);
 }
 
-/* Request one page from the source VM at the given start address.
+/* Request pages from the source VM at the given start address.
  *   rb: the RAMBlock to request the page in
  *   Start: Address offset within the RB
  *   Len: Length in bytes required - must be a multiple of pagesize
  */
 int migrate_send_rp_message_req_pages(MigrationIncomingState *mis,
-                                      RAMBlock *rb, ram_addr_t start)
+                                      RAMBlock *rb, ram_addr_t start,
+                                      size_t len)
 {
     uint8_t bufc[12 + 1 + 255]; /* start (8), len (4), rbname up to 256 */
     size_t msglen = 12; /* start + len */
-    size_t len = qemu_ram_pagesize(rb);
     enum mig_rp_message_type msg_type;
     const char *rbname;
     int rbname_len;
@@ -568,9 +570,39 @@ int migrate_send_rp_message_req_pages(MigrationIncomingState *mis,
     return migrate_send_rp_message(mis, msg_type, msglen, bufc);
 }
 
+/*
+ * Tell the source that pages in the given range will probably be needed
+ * soon.  Unlike a page request this does not block other requests: the
+ * source only moves its background stream there.
+ *   rb: the RAMBlock of the range
+ *   Start: Address offset within the RB
+ *   Len: Length in bytes of the range - must be a multiple of pagesize
+ */
+int migrate_send_rp_message_req_pages_ahead(MigrationIncomingState *mis,
+                                            RAMBlock *rb, ram_addr_t start,
+                                            size_t len)
+{
+    uint8_t bufc[12 + 1 + 255]; /* start (8), len (4), rbname up to 256 */
+    size_t msglen = 12; /* start + len */
+    const char *rbname = qemu_ram_get_idstr(rb);
+    int rbname_len = strlen(rbname);
+
+    assert(rbname_len < 256);
+
+    *(uint64_t *)bufc = cpu_to_be64((uint64_t)start);
+    *(uint32_t *)(bufc + 8) = cpu_to_be32((uint32_t)len);
+    /* Always name the block, last_rb only tracks page requests */
+    bufc[msglen++] = rbname_len;
+    memcpy(bufc + msglen, rbname, rbname_len);
+    msglen += rbname_len;
+
+    return migrate_send_rp_message(mis, MIG_RP_MSG_REQ_PAGES_AHEAD,
+                                   msglen, bufc);
+}
+
 int migrate_send_rp_req_pages(MigrationIncomingState *mis,
-                              RAMBlock *rb, ram_addr_t start, uint64_t haddr,
-                              uint32_t tid)
+                              RAMBlock *rb, ram_addr_t start, size_t len,
+                              uint64_t haddr, uint32_t tid)
 {
     void *aligned = (void *)(uintptr_t)ROUND_DOWN(haddr, qemu_ram_pagesize(rb));
     bool received = false;
@@ -601,7 +633,7 @@ int migrate_send_rp_req_pages(MigrationIncomingState *mis,
         return 0;
     }
 
-    return migrate_send_rp_message_req_pages(mis, rb, start);
+    return migrate_send_rp_message_req_pages(mis, rb, start, len);
 }
 
 static bool migration_colo_enabled;
@@ -2133,6 +2165,7 @@ static struct rp_cmd_args {
     [MIG_RP_MSG_RECV_BITMAP]    = { .len = -1, .name = "RECV_BITMAP" },
     [MIG_RP_MSG_RESUME_ACK]     = { .len =  4, .name = "RESUME_ACK" },
     [MIG_RP_MSG_SWITCHOVER_ACK] = { .len =  0, .name = "SWITCHOVER_ACK" },
+    [MIG_RP_MSG_REQ_PAGES_AHEAD] = { .len = -1, .name = "REQ_PAGES_AHEAD" },
     [MIG_RP_MSG_MAX]            = { .len = -1, .name = "MAX" },
 };
 
@@ -2163,6 +2196,26 @@ migrate_handle_rp_req_pages(MigrationState *ms, const char* rbname,
     ram_save_queue_pages(rbname, start, len, errp);
 }
 
+/*
+ * Process a fault-ahead hint received on the return path: the range is
+ * not queued, the background stream just continues from there.
+ */
+static void
+migrate_handle_rp_req_pages_ahead(MigrationState *ms, const char *rbname,
+                                  ram_addr_t start, size_t len, Error **errp)
+{
+    long our_host_ps = qemu_real_host_page_size();
+
+    if (!QEMU_IS_ALIGNED(start, our_host_ps) ||
+        !QEMU_IS_ALIGNED(len, our_host_ps)) {
+        error_setg(errp, "MIG_RP_MSG_REQ_PAGES_AHEAD: Misaligned range, "
+                   "start: " RAM_ADDR_FMT " len: %zd", start, len);
+        return;
+    }
+
+    ram_save_hint_pages(rbname, start, len, errp);
+}
+
 static bool migrate_handle_rp_recv_bitmap(MigrationState *s, char *block_name,
                                           Error **errp)
 {
@@ -2322,6 +2375,7 @@ static void *source_return_path_thread(void *opaque)
             break;
 
         case MIG_RP_MSG_REQ_PAGES_ID:
+        case MIG_RP_MSG_REQ_PAGES_AHEAD:
             expected_len = 12 + 1; /* header + termination */
 
             if (header_len >= expected_len) {
@@ -2337,8 +2391,13 @@ static void *source_return_path_thread(void *opaque)
                            header_len, expected_len);
                 goto out;
             }
-            migrate_handle_rp_req_pages(ms, (char *)&buf[13], start, len,
-                                        &err);
+            if (header_type == MIG_RP_MSG_REQ_PAGES_AHEAD) {
+                migrate_handle_rp_req_pages_ahead(ms, (char *)&buf[13],
+                                                  start, len, &err);
+            } else {
+                migrate_handle_rp_req_pages(ms, (char *)&buf[13], start, len,
+                                            &err);
+            }
             if (err) {
                 goto out;
             }
@@ -128,6 +128,15 @@ struct MigrationIncomingState {
     QemuMutex rp_mutex;    /* We send replies from multiple threads */
     /* RAMBlock of last request sent to source */
     RAMBlock *last_rb;
+    /*
+     * Fault-ahead state of the postcopy fault thread: the range covered
+     * by the last userfault and its fault-ahead hint, and its size in
+     * host pages.
+     */
+    RAMBlock *fault_rb;
+    ram_addr_t fault_start;
+    ram_addr_t fault_end;
+    unsigned int fault_window;
     /*
      * Number of postcopy channels including the default precopy channel, so
      * vanilla postcopy will only contain one channel which contain both
@@ -557,9 +566,14 @@ void migrate_send_rp_shut(MigrationIncomingState *mis,
 void migrate_send_rp_pong(MigrationIncomingState *mis,
                           uint32_t value);
 int migrate_send_rp_req_pages(MigrationIncomingState *mis, RAMBlock *rb,
-                              ram_addr_t start, uint64_t haddr, uint32_t tid);
+                              ram_addr_t start, size_t len,
+                              uint64_t haddr, uint32_t tid);
 int migrate_send_rp_message_req_pages(MigrationIncomingState *mis,
-                                      RAMBlock *rb, ram_addr_t start);
+                                      RAMBlock *rb, ram_addr_t start,
+                                      size_t len);
+int migrate_send_rp_message_req_pages_ahead(MigrationIncomingState *mis,
+                                            RAMBlock *rb, ram_addr_t start,
+                                            size_t len);
 void migrate_send_rp_recv_bitmap(MigrationIncomingState *mis,
                                  char *block_name);
 void migrate_send_rp_resume_ack(MigrationIncomingState *mis, uint32_t value);
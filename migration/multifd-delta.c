@@ -0,0 +1,354 @@
+/*
+ * Multifd delta encoding implementation
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/bswap.h"
+#include "qemu/host-utils.h"
+#include "qemu/memalign.h"
+#include "qemu/thread.h"
+#include "system/ramblock.h"
+#include "exec/target_page.h"
+#include "qapi/error.h"
+#include "migration.h"
+#include "options.h"
+#include "xbzrle.h"
+#include "multifd.h"
+
+/*
+ * Each normal page in a packet is preceded by a 32-bit big endian
+ * header.  If MULTIFD_DELTA_ENCODED is set, the low bits are the size
+ * of the XBZRLE encoding of the page against its previous contents;
+ * otherwise the full page follows.
+ */
+#define MULTIFD_DELTA_HDR_SIZE  4
+#define MULTIFD_DELTA_ENCODED   (1u << 31)
+
+#define DELTA_CACHE_SHARDS      64
+
+/*
+ * Last sent contents of recently sent pages, shared by all channels
+ * because a page is not tied to a channel.  The destination applies
+ * a delta onto its copy of the page, so an entry must always match
+ * what the destination has.  That holds because the same page can only
+ * be sent again after a multifd sync.
+ *
+ * The cache is direct mapped; slots are spread over a few locks so
+ * that channels do not contend with each other.
+ */
+typedef struct {
+    size_t n_slots;
+    ram_addr_t *keys;
+    uint8_t *data;
+    QemuMutex locks[DELTA_CACHE_SHARDS];
+} DeltaCache;
+
+static DeltaCache *delta_cache;
+static unsigned delta_cache_users;
+
+struct delta_data {
+    /* snapshot of the page being encoded */
+    uint8_t *page;
+    /* encoded packet payload */
+    uint8_t *buf;
+    uint32_t buf_len;
+};
+
+static void delta_cache_init(void)
+{
+    uint32_t page_size = multifd_ram_page_size();
+    uint64_t n_slots = migrate_xbzrle_cache_size() / page_size;
+    size_t i;
+
+    if (delta_cache_users++) {
+        return;
+    }
+
+    delta_cache = g_new0(DeltaCache, 1);
+    delta_cache->n_slots = pow2floor(MAX(n_slots, 1));
+    delta_cache->keys = g_new(ram_addr_t, delta_cache->n_slots);
+    for (i = 0; i < delta_cache->n_slots; i++) {
+        delta_cache->keys[i] = RAM_ADDR_INVALID;
+    }
+    delta_cache->data = qemu_memalign(page_size,
+                                      delta_cache->n_slots * page_size);
+    for (i = 0; i < DELTA_CACHE_SHARDS; i++) {
+        qemu_mutex_init(&delta_cache->locks[i]);
+    }
+}
+
+static void delta_cache_cleanup(void)
+{
+    size_t i;
+
+    if (--delta_cache_users) {
+        return;
+    }
+
+    for (i = 0; i < DELTA_CACHE_SHARDS; i++) {
+        qemu_mutex_destroy(&delta_cache->locks[i]);
+    }
+    qemu_vfree(delta_cache->data);
+    g_free(delta_cache->keys);
+    g_free(delta_cache);
+    delta_cache = NULL;
+}
+
+static size_t delta_cache_slot(ram_addr_t addr)
+{
+    return (addr >> qemu_target_page_bits()) & (delta_cache->n_slots - 1);
+}
+
+static QemuMutex *delta_cache_lock(size_t slot)
+{
+    return &delta_cache->locks[slot % DELTA_CACHE_SHARDS];
+}
+
+/*
+ * Encode the page at @addr, whose current contents are in @page, into
+ * @out.  Returns the number of bytes written.
+ */
+static uint32_t delta_encode_page(ram_addr_t addr, uint8_t *page,
+                                  uint8_t *out)
+{
+    uint32_t page_size = multifd_ram_page_size();
+    size_t slot = delta_cache_slot(addr);
+    uint8_t *cached = delta_cache->data + slot * page_size;
+    uint8_t *dst = out + MULTIFD_DELTA_HDR_SIZE;
+    int len = -1;
+
+    QEMU_LOCK_GUARD(delta_cache_lock(slot));
+
+    if (delta_cache->keys[slot] == addr) {
+        len = xbzrle_encode_buffer(cached, page, page_size,
+                                   dst, page_size - 1);
+    }
+    memcpy(cached, page, page_size);
+    delta_cache->keys[slot] = addr;
+
+    if (len < 0) {
+        stl_be_p(out, page_size);
+        memcpy(dst, page, page_size);
+        return MULTIFD_DELTA_HDR_SIZE + page_size;
+    }
+    stl_be_p(out, MULTIFD_DELTA_ENCODED | len);
+    return MULTIFD_DELTA_HDR_SIZE + len;
+}
+
+/* The destination zeroes these pages behind our back, forget them. */
+static void delta_cache_drop(ram_addr_t addr)
+{
+    size_t slot = delta_cache_slot(addr);
+
+    QEMU_LOCK_GUARD(delta_cache_lock(slot));
+
+    if (delta_cache->keys[slot] == addr) {
+        delta_cache->keys[slot] = RAM_ADDR_INVALID;
+    }
+}
+
+/* Multifd delta encoding */
+
+static int multifd_delta_send_setup(MultiFDSendParams *p, Error **errp)
+{
+    uint32_t page_size = multifd_ram_page_size();
+    struct delta_data *d = g_new0(struct delta_data, 1);
+
+    d->buf_len = multifd_ram_page_count() *
+                 (MULTIFD_DELTA_HDR_SIZE + page_size);
+    d->buf = g_try_malloc(d->buf_len);
+    if (!d->buf) {
+        g_free(d);
+        error_setg(errp, "multifd %u: out of memory for delta buffer", p->id);
+        return -1;
+    }
+    d->page = qemu_memalign(page_size, page_size);
+    p->compress_data = d;
+
+    delta_cache_init();
+
+    /* Needs 2 IOVs, one for packet header and one for encoded data */
+    p->iov = g_new0(struct iovec, 2);
+
+    return 0;
+}
+
+static void multifd_delta_send_cleanup(MultiFDSendParams *p, Error **errp)
+{
+    struct delta_data *d = p->compress_data;
+
+    if (!d) {
+        return;
+    }
+    delta_cache_cleanup();
+
+    qemu_vfree(d->page);
+    g_free(d->buf);
+    g_free(p->compress_data);
+    p->compress_data = NULL;
+
+    g_free(p->iov);
+    p->iov = NULL;
+}
+
+static int multifd_delta_send_prepare(MultiFDSendParams *p, Error **errp)
+{
+    MultiFDPages_t *pages = &p->data->u.ram;
+    struct delta_data *d = p->compress_data;
+    uint32_t page_size = multifd_ram_page_size();
+    uint32_t out_size = 0;
+    bool has_normal;
+    uint32_t i;
+
+    has_normal = multifd_send_prepare_common(p);
+
+    for (i = pages->normal_num; i < pages->num; i++) {
+        delta_cache_drop(pages->block->offset + pages->offset[i]);
+    }
+
+    if (!has_normal) {
+        goto out;
+    }
+
+    for (i = 0; i < pages->normal_num; i++) {
+        /*
+         * The VM might be running, so encode and cache a stable copy
+         * of the page: the destination must end up with exactly the
+         * contents that are stored in the cache.
+         */
+        memcpy(d->page, pages->block->host + pages->offset[i], page_size);
+        out_size += delta_encode_page(pages->block->offset + pages->offset[i],
+                                      d->page, d->buf + out_size);
+    }
+    p->iov[p->iovs_num].iov_base = d->buf;
+    p->iov[p->iovs_num].iov_len = out_size;
+    p->iovs_num++;
+    p->next_packet_size = out_size;
+
+out:
+    p->flags |= MULTIFD_FLAG_DELTA;
+    multifd_send_fill_packet(p);
+    return 0;
+}
+
+static int multifd_delta_recv_setup(MultiFDRecvParams *p, Error **errp)
+{
+    struct delta_data *d = g_new0(struct delta_data, 1);
+
+    d->buf_len = multifd_ram_page_count() *
+                 (MULTIFD_DELTA_HDR_SIZE + multifd_ram_page_size());
+    d->buf = g_try_malloc(d->buf_len);
+    if (!d->buf) {
+        g_free(d);
+        error_setg(errp, "multifd %u: out of memory for delta buffer", p->id);
+        return -1;
+    }
+    p->compress_data = d;
+    return 0;
+}
+
+static void multifd_delta_recv_cleanup(MultiFDRecvParams *p)
+{
+    struct delta_data *d = p->compress_data;
+
+    if (!d) {
+        return;
+    }
+    g_free(d->buf);
+    g_free(p->compress_data);
+    p->compress_data = NULL;
+}
+
+static int multifd_delta_recv(MultiFDRecvParams *p, Error **errp)
+{
+    struct delta_data *d = p->compress_data;
+    uint32_t in_size = p->next_packet_size;
+    uint32_t page_size = multifd_ram_page_size();
+    uint32_t flags = p->flags & MULTIFD_FLAG_COMPRESSION_MASK;
+    uint32_t pos = 0;
+    int ret;
+    int i;
+
+    if (flags != MULTIFD_FLAG_DELTA) {
+        error_setg(errp, "multifd %u: flags received %x flags expected %x",
+                   p->id, flags, MULTIFD_FLAG_DELTA);
+        return -1;
+    }
+
+    multifd_recv_zero_page_process(p);
+
+    if (!p->normal_num) {
+        assert(in_size == 0);
+        return 0;
+    }
+
+    if (in_size > d->buf_len) {
+        error_setg(errp, "multifd %u: packet size %u exceeds %u",
+                   p->id, in_size, d->buf_len);
+        return -1;
+    }
+
+    ret = qio_channel_read_all(p->c, (void *)d->buf, in_size, errp);
+    if (ret != 0) {
+        return ret;
+    }
+
+    for (i = 0; i < p->normal_num; i++) {
+        uint8_t *page = p->host + p->normal[i];
+        uint32_t hdr, len;
+
+        if (in_size - pos < MULTIFD_DELTA_HDR_SIZE) {
+            goto truncated;
+        }
+        hdr = ldl_be_p(d->buf + pos);
+        pos += MULTIFD_DELTA_HDR_SIZE;
+        len = hdr & ~MULTIFD_DELTA_ENCODED;
+        if (len > page_size || in_size - pos < len) {
+            goto truncated;
+        }
+
+        ramblock_recv_bitmap_set_offset(p->block, p->normal[i]);
+        if (!(hdr & MULTIFD_DELTA_ENCODED)) {
+            if (len != page_size) {
+                goto truncated;
+            }
+            memcpy(page, d->buf + pos, page_size);
+        } else if (len &&
+                   xbzrle_decode_buffer(d->buf + pos, len,
+                                        page, page_size) < 0) {
+            error_setg(errp, "multifd %u: failed to decode page at 0x%"
+                       PRIx64, p->id, (uint64_t)p->normal[i]);
+            return -1;
+        }
+        pos += len;
+    }
+
+    if (pos != in_size) {
+        goto truncated;
+    }
+    return 0;
+
+truncated:
+    error_setg(errp, "multifd %u: malformed delta packet of size %u",
+               p->id, in_size);
+    return -1;
+}
+
+static const MultiFDMethods multifd_delta_ops = {
+    .send_setup = multifd_delta_send_setup,
+    .send_cleanup = multifd_delta_send_cleanup,
+    .send_prepare = multifd_delta_send_prepare,
+    .recv_setup = multifd_delta_recv_setup,
+    .recv_cleanup = multifd_delta_recv_cleanup,
+    .recv = multifd_delta_recv
+};
+
+static void multifd_delta_register(void)
+{
+    multifd_register_ops(MULTIFD_COMPRESSION_DELTA, &multifd_delta_ops);
+}
+
+migration_init(multifd_delta_register);
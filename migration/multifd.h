@@ -66,6 +66,12 @@ MultiFDRecvData *multifd_get_recv_data(void);
 #define MULTIFD_FLAG_QPL (4 << 1)
 #define MULTIFD_FLAG_UADK (8 << 1)
 #define MULTIFD_FLAG_QATZIP (16 << 1)
+/*
+ * All five bits are taken by the methods above, so from here on the
+ * field is an enumeration rather than a set of bits: receivers compare
+ * it against their own value as a whole.  3 is the first free value.
+ */
+#define MULTIFD_FLAG_DELTA (3 << 1)
 
 /*
  * If set it means that this packet contains device state
@@ -27,6 +27,7 @@ extern const size_t migration_properties_count;
 
 bool migrate_auto_converge(void);
 bool migrate_colo(void);
+bool migrate_defer_hot_pages(void);
 bool migrate_dirty_bitmaps(void);
 bool migrate_events(void);
 bool migrate_mapped_ram(void);
@@ -35,6 +36,7 @@ bool migrate_late_block_activate(void);
 bool migrate_multifd(void);
 bool migrate_pause_before_switchover(void);
 bool migrate_postcopy_blocktime(void);
+bool migrate_postcopy_fault_ahead(void);
 bool migrate_postcopy_preempt(void);
 bool migrate_rdma_pin_all(void);
 bool migrate_release_ram(void);
@@ -18,6 +18,7 @@
 
 #include "qemu/osdep.h"
 #include "qemu/madvise.h"
+#include "qemu/units.h"
 #include "exec/target_page.h"
 #include "migration.h"
 #include "qemu-file.h"
@@ -973,7 +974,67 @@ static int postcopy_request_page(MigrationIncomingState *mis, RAMBlock *rb,
         return received ? 0 : postcopy_place_page_zero(mis, aligned, rb);
     }
 
-    return migrate_send_rp_req_pages(mis, rb, start, haddr, tid);
+    return migrate_send_rp_req_pages(mis, rb, start, qemu_ram_pagesize(rb),
+                                     haddr, tid);
+}
+
+/* Upper bound of a fault-ahead request, in bytes */
+#define POSTCOPY_FAULT_AHEAD_MAX (1 * MiB)
+
+/*
+ * Called once the host page at @start has been requested for a userfault.
+ * Guests touching memory sequentially fault right past the previous
+ * fault-ahead range; double the range each time that happens, and ask
+ * the source to continue its background stream there so that the pages
+ * are already on their way when the vCPU gets to them.  This is only a
+ * hint: the source keeps serving page requests first, so a large range
+ * never delays the faults of other vCPUs.  Any other access pattern goes
+ * back to the faulting page alone.
+ */
+static int postcopy_fault_ahead(MigrationIncomingState *mis, RAMBlock *rb,
+                                ram_addr_t start)
+{
+    size_t pagesize = qemu_ram_pagesize(rb);
+    unsigned int max = MAX(POSTCOPY_FAULT_AHEAD_MAX / pagesize, 1);
+    unsigned int window;
+
+    if (!migrate_postcopy_fault_ahead()) {
+        return 0;
+    }
+
+    /* Nothing was requested for discarded or already received pages */
+    if (ramblock_page_is_discarded(rb, start) ||
+        ramblock_recv_bitmap_test_byte_offset(rb, start)) {
+        return 0;
+    }
+
+    if (rb == mis->fault_rb && start > mis->fault_start &&
+        start < mis->fault_end) {
+        /* Already hinted, but the vCPU got there first */
+        return 0;
+    }
+
+    if (rb == mis->fault_rb && start == mis->fault_end) {
+        window = MIN(mis->fault_window * 2, max);
+    } else {
+        window = 1;
+    }
+    /* The source rejects requests that overrun the RAMBlock */
+    window = MIN(window, (rb->used_length - start) / pagesize);
+    window = MAX(window, 1);
+
+    mis->fault_rb = rb;
+    mis->fault_start = start;
+    mis->fault_end = start + (ram_addr_t)window * pagesize;
+    mis->fault_window = window;
+
+    if (window == 1) {
+        return 0;
+    }
+    /* The faulting page itself was requested on its own */
+    return migrate_send_rp_message_req_pages_ahead(mis, rb, start + pagesize,
+                                                   (size_t)(window - 1) *
+                                                   pagesize);
 }
 
 /*
@@ -1395,6 +1456,9 @@ retry:
             ret = postcopy_request_page(mis, rb, rb_offset,
                                         msg.arg.pagefault.address,
                                         msg.arg.pagefault.feat.ptid);
+            if (!ret) {
+                ret = postcopy_fault_ahead(mis, rb, rb_offset);
+            }
             if (ret) {
                 /* May be network failure, try to wait for recovery */
                 postcopy_pause_fault_thread(mis);
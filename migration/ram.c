@@ -137,6 +137,8 @@ struct PageSearchStatus {
     bool         complete_round;
     /* Whether we're sending a host page */
     bool          host_page_sending;
+    /* Whether pages in the block's hot_bmap are skipped */
+    bool          skip_hot;
     /* The start/end of current host page.  Invalid if host_page_sending==false */
     unsigned long host_page_start;
     unsigned long host_page_end;
@@ -381,6 +383,10 @@ struct RAMState {
     ram_addr_t last_page;
     /* last ram version we have seen */
     uint32_t last_version;
+    /* Whether hot pages are still held back in this round */
+    bool defer_hot;
+    /* Whether a hot page was held back since the last sync */
+    bool hot_skipped;
     /* How many times we have dirty too many pages */
     int dirty_rate_high_cnt;
     /* these variables are used for bitmap sync */
@@ -428,8 +434,8 @@ struct RAMState {
      */
     unsigned int postcopy_bmap_sync_requested;
     /*
-     * Page hint during postcopy when preempt mode is on.  Return path
-     * thread sets it, while background migration thread consumes it.
+     * Page hint during postcopy, for preempt mode and fault-ahead.  Return
+     * path thread sets it, while background migration thread consumes it.
      *
      * Protected by @bitmap_mutex.
      */
@@ -711,6 +717,46 @@ static int save_xbzrle_page(RAMState *rs, PageSearchStatus *pss,
     return 1;
 }
 
+/**
+ * find_next_cold_page: find the next page that is dirty but not hot
+ *
+ * Like find_next_bit() on (@bmap & ~@hot).  Sets *@skipped if a dirty
+ * hot page was passed over on the way.
+ */
+static unsigned long find_next_cold_page(const unsigned long *bmap,
+                                         const unsigned long *hot,
+                                         unsigned long size,
+                                         unsigned long page,
+                                         bool *skipped)
+{
+    unsigned long word = BIT_WORD(page);
+    unsigned long mask, bits, cold;
+
+    if (page >= size) {
+        return size;
+    }
+
+    mask = BITMAP_FIRST_WORD_MASK(page);
+    while (true) {
+        if (word == BIT_WORD(size - 1)) {
+            mask &= BITMAP_LAST_WORD_MASK(size);
+        }
+        bits = bmap[word] & mask;
+        cold = bits & ~hot[word];
+        /* Only hot pages before the cold one found are passed over */
+        if (bits & hot[word] & (cold ? (cold & -cold) - 1 : ~0UL)) {
+            *skipped = true;
+        }
+        if (cold) {
+            return word * BITS_PER_LONG + ctzl(cold);
+        }
+        if (++word >= BITS_TO_LONGS(size)) {
+            return size;
+        }
+        mask = ~0UL;
+    }
+}
+
 /**
  * pss_find_next_dirty: find the next dirty page of current ramblock
  *
@@ -743,6 +789,12 @@ static void pss_find_next_dirty(PageSearchStatus *pss)
         size = MIN(size, pss->host_page_end);
     }
 
+    if (pss->skip_hot && rb->hot_bmap && !pss->host_page_sending) {
+        pss->page = find_next_cold_page(bitmap, rb->hot_bmap, size, pss->page,
+                                        &ram_state->hot_skipped);
+        return;
+    }
+
     pss->page = find_next_bit(bitmap, size, pss->page);
 }
 
@@ -944,6 +996,8 @@ static uint64_t physical_memory_sync_dirty_bitmap(RAMBlock *rb,
     unsigned long word = BIT_WORD((start + rb->offset) >> TARGET_PAGE_BITS);
     uint64_t num_dirty = 0;
     unsigned long *dest = rb->bmap;
+    unsigned long *hot = rb->hot_bmap;
+    unsigned long *warm = rb->warm_bmap;
 
     /* start address and length is aligned at the start of a word? */
     if (((word * BITS_PER_LONG) << TARGET_PAGE_BITS) ==
@@ -961,14 +1015,21 @@ static uint64_t physical_memory_sync_dirty_bitmap(RAMBlock *rb,
                 &ram_list.dirty_memory[DIRTY_MEMORY_MIGRATION])->blocks;
 
         for (k = page; k < page + nr; k++) {
+            unsigned long bits = 0;
+
             if (src[idx][offset]) {
-                unsigned long bits = qatomic_xchg(&src[idx][offset], 0);
                 unsigned long new_dirty;
+                bits = qatomic_xchg(&src[idx][offset], 0);
                 new_dirty = ~dest[k];
                 dest[k] |= bits;
                 new_dirty &= bits;
                 num_dirty += ctpopl(new_dirty);
             }
+            if (hot) {
+                /* Hot means written in two consecutive periods */
+                hot[k] = bits & warm[k];
+                warm[k] = bits;
+            }
 
             if (++offset >= BITS_TO_LONGS(DIRTY_MEMORY_BLOCK_SIZE)) {
                 offset = 0;
@@ -997,6 +1058,13 @@ static uint64_t physical_memory_sync_dirty_bitmap(RAMBlock *rb,
                         length,
                         DIRTY_MEMORY_MIGRATION,
                         dest);
+        /* No per-period information here, treat everything as cold */
+        if (hot) {
+            bitmap_clear(hot, start >> TARGET_PAGE_BITS,
+                         length >> TARGET_PAGE_BITS);
+            bitmap_clear(warm, start >> TARGET_PAGE_BITS,
+                         length >> TARGET_PAGE_BITS);
+        }
     }
 
     return num_dirty;
@@ -1152,6 +1220,8 @@ static void migration_bitmap_sync(RAMState *rs, bool last_stage)
             }
             qatomic_set(&mig_stats.dirty_bytes_last_sync, ram_bytes_remaining());
         }
+        rs->defer_hot = migrate_defer_hot_pages() && !last_stage;
+        rs->hot_skipped = false;
     }
 
     memory_global_after_dirty_log_sync();
@@ -1354,6 +1424,12 @@ static int ram_save_multifd_page(RAMBlock *block, ram_addr_t offset)
 #define PAGE_ALL_CLEAN 0
 #define PAGE_TRY_AGAIN 1
 #define PAGE_DIRTY_FOUND 2
+
+/*
+ * Maximum number of target pages ram_find_and_save_block() hands to
+ * multifd in one call.
+ */
+#define MULTIFD_SAVE_BATCH_PAGES 64
 /**
  * find_dirty_block: find the next dirty page and update any state
  * associated with the search process.
@@ -1925,6 +2001,51 @@ static void migration_page_queue_free(RAMState *rs)
     }
 }
 
+/**
+ * ram_save_hint_pages: continue the background stream at a given range
+ *
+ * A fault-ahead hint from the postcopy destination.  Unlike
+ * ram_save_queue_pages() nothing is queued: the background stream picks
+ * up from @start the next time it looks for a page, while requested
+ * pages are still sent first.
+ *
+ * Returns zero on success or negative on error
+ *
+ * @rbname: Name of the RAMBLock of the hint
+ * @start: starting address from the start of the RAMBlock
+ * @len: length (in bytes) of the range expected to be needed soon
+ */
+int ram_save_hint_pages(const char *rbname, ram_addr_t start, ram_addr_t len,
+                        Error **errp)
+{
+    RAMBlock *ramblock;
+    RAMState *rs = ram_state;
+
+    RCU_READ_LOCK_GUARD();
+
+    ramblock = qemu_ram_block_by_name(rbname);
+    if (!ramblock) {
+        error_setg(errp, "MIG_RP_MSG_REQ_PAGES_AHEAD has no block '%s'",
+                   rbname);
+        return -1;
+    }
+    trace_ram_save_hint_pages(ramblock->idstr, start, len);
+    if (!len || !offset_in_ramblock(ramblock, start + len - 1)) {
+        error_setg(errp, "MIG_RP_MSG_REQ_PAGES_AHEAD request overrun, "
+                   "start=" RAM_ADDR_FMT " len="
+                   RAM_ADDR_FMT " blocklen=" RAM_ADDR_FMT,
+                   start, len, ramblock->used_length);
+        return -1;
+    }
+
+    WITH_QEMU_LOCK_GUARD(&rs->bitmap_mutex) {
+        rs->page_hint.location.block = ramblock;
+        rs->page_hint.location.offset = start >> TARGET_PAGE_BITS;
+        rs->page_hint.valid = true;
+    }
+    return 0;
+}
+
 /**
  * ram_save_queue_pages: queue the page for transmission
  *
@@ -2284,8 +2405,11 @@ static int ram_save_host_page(RAMState *rs, PageSearchStatus *pss)
 
 static bool ram_page_hint_valid(RAMState *rs)
 {
-    /* There's only page hint during postcopy preempt mode */
-    if (!postcopy_preempt_active()) {
+    /*
+     * Hints come from urgent pages in postcopy preempt mode, and from
+     * fault-ahead requests of the destination in any postcopy mode.
+     */
+    if (!migration_in_postcopy()) {
         return false;
     }
 
@@ -2351,13 +2475,21 @@ static int ram_find_and_save_block(RAMState *rs)
     }
 
     pss_init(pss, next_block, next_page);
+    pss->skip_hot = rs->defer_hot && !rs->last_stage &&
+                    !migration_in_postcopy();
 
     while (true){
         if (!get_queued_page(rs, pss)) {
             /* priority queue empty, so just search for something dirty */
             int res = find_dirty_block(rs, pss);
 
-            if (res == PAGE_ALL_CLEAN) {
+            if (res == PAGE_ALL_CLEAN && pss->skip_hot && rs->hot_skipped) {
+                /* Only hot pages are left, send them until the next sync */
+                rs->defer_hot = false;
+                pss->skip_hot = false;
+                pss->complete_round = false;
+                continue;
+            } else if (res == PAGE_ALL_CLEAN) {
                 break;
             } else if (res == PAGE_TRY_AGAIN) {
                 continue;
@@ -2375,6 +2507,30 @@ static int ram_find_and_save_block(RAMState *rs)
         }
     }
 
+    /*
+     * With multifd the pages are only queued here and the channel threads
+     * do the actual work, so the per-call overhead in ram_save_iterate()
+     * dominates.  Keep queueing the following dirty pages of the same
+     * block, as long as nobody is waiting for a specific page.
+     */
+    while (pages > 0 && pages < MULTIFD_SAVE_BATCH_PAGES &&
+           migrate_multifd() && !migration_in_postcopy() &&
+           !postcopy_has_request(rs)) {
+        int tmppages;
+
+        pss_find_next_dirty(pss);
+        if (!offset_in_ramblock(pss->block,
+                                ((ram_addr_t)pss->page) << TARGET_PAGE_BITS)) {
+            break;
+        }
+        tmppages = ram_save_host_page(rs, pss);
+        if (tmppages < 0) {
+            pages = tmppages;
+            break;
+        }
+        pages += tmppages;
+    }
+
     rs->last_seen_block = pss->block;
     rs->last_page = pss->page;
 
@@ -2454,6 +2610,10 @@ static void ram_bitmaps_destroy(void)
         block->clear_bmap = NULL;
         g_free(block->bmap);
         block->bmap = NULL;
+        g_free(block->hot_bmap);
+        block->hot_bmap = NULL;
+        g_free(block->warm_bmap);
+        block->warm_bmap = NULL;
         g_free(block->file_bmap);
         block->file_bmap = NULL;
     }
@@ -2852,6 +3012,10 @@ static void ram_list_init_bitmaps(void)
             if (migrate_mapped_ram()) {
                 block->file_bmap = bitmap_new(pages);
             }
+            if (migrate_defer_hot_pages()) {
+                block->hot_bmap = bitmap_new(pages);
+                block->warm_bmap = bitmap_new(pages);
+            }
             block->clear_bmap_shift = shift;
             block->clear_bmap = bitmap_new(clear_bmap_size(pages, shift));
         }
@@ -289,6 +289,23 @@ static void flatview_insert(FlatView *view, unsigned pos, FlatRange *range)
     ++view->nr;
 }
 
+/* Return the index of the first range in @view that ends after @addr. */
+static unsigned flatview_find_index(FlatView *view, Int128 addr)
+{
+    unsigned lo = 0, hi = view->nr;
+
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+
+        if (int128_ge(addr, addrrange_end(view->ranges[mid].addr))) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
 static void flatview_destroy(FlatView *view)
 {
     int i;
@@ -654,8 +671,12 @@ static void render_memory_region(FlatView *view,
     fr.nonvolatile = nonvolatile;
     fr.unmergeable = unmergeable;
 
-    /* Render the region itself into any gaps left by the current view. */
-    for (i = 0; i < view->nr && int128_nz(remain); ++i) {
+    /*
+     * Render the region itself into any gaps left by the current view.
+     * The view is sorted, so skip the ranges that end before @base.
+     */
+    for (i = flatview_find_index(view, base);
+         i < view->nr && int128_nz(remain); ++i) {
         if (int128_ge(base, addrrange_end(view->ranges[i].addr))) {
             continue;
         }
@@ -3233,6 +3254,7 @@ void address_space_init(AddressSpace *as, MemoryRegion *root, const char *name)
     QTAILQ_INSERT_TAIL(&address_spaces, as, address_spaces_link);
     as->max_bounce_buffer_size = DEFAULT_MAX_BOUNCE_BUFFER_SIZE;
     as->bounce_buffer_size = 0;
+    as->bounce_buffer_cache = NULL;
     qemu_mutex_init(&as->map_client_list_lock);
     QLIST_INIT(&as->map_client_list);
     as->name = g_strdup(name ? name : "anonymous");
@@ -3244,6 +3266,7 @@ static void do_address_space_destroy(AddressSpace *as)
 {
     assert(qatomic_read(&as->bounce_buffer_size) == 0);
     assert(QLIST_EMPTY(&as->map_client_list));
+    g_free(as->bounce_buffer_cache);
     qemu_mutex_destroy(&as->map_client_list_lock);
 
     assert(QTAILQ_EMPTY(&as->listeners));
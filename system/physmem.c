@@ -1100,23 +1100,44 @@ uint64_t physical_memory_test_and_clear_dirty(ram_addr_t start,
         assert(start >= ramblock->offset &&
                start + length <= ramblock->offset + ramblock->used_length);
 
+        /*
+         * Work one bitmap word at a time: clean words are only read, and
+         * dirty words are cleared with a single atomic operation.  A word
+         * never straddles two DirtyMemoryBlocks.
+         */
         while (page < end) {
             unsigned long idx = page / DIRTY_MEMORY_BLOCK_SIZE;
             unsigned long offset = page % DIRTY_MEMORY_BLOCK_SIZE;
+            unsigned long bit = offset % BITS_PER_LONG;
+            unsigned long num = MIN(end - page, BITS_PER_LONG - bit);
+            unsigned long *p = &blocks->blocks[idx][BIT_WORD(offset)];
+            unsigned long mask = BITMAP_FIRST_WORD_MASK(bit) &
+                                 BITMAP_LAST_WORD_MASK(bit + num);
+            unsigned long bits = qatomic_read(p) & mask;
+
+            if (bits) {
+                bits = qatomic_fetch_and(p, ~mask) & mask;
+            }
+            if (bmap) {
+                unsigned long k0 = page - bit -
+                                   (ramblock->offset >> TARGET_PAGE_BITS);
 
-            if (bitmap_test_and_clear_atomic(blocks->blocks[idx], offset, 1)) {
-                if (bmap) {
-                    unsigned long k = page - (ramblock->offset >> TARGET_PAGE_BITS);
+                while (bits) {
+                    unsigned long k = k0 + ctzl(bits);
+
+                    bits &= bits - 1;
                     if (!test_and_set_bit(k, bmap)) {
                         num_dirty++;
                     }
-                } else {
-                    num_dirty++;
                 }
+            } else {
+                num_dirty += ctpopl(bits);
             }
 
-            page++;
+            page += num;
         }
+        /* Order the clearing against the caller's reads of the pages. */
+        smp_mb();
 
         mr_offset = (ram_addr_t)(start_page << TARGET_PAGE_BITS) - ramblock->offset;
         mr_size = (end - start_page) << TARGET_PAGE_BITS;
@@ -3533,9 +3554,42 @@ typedef struct {
     MemoryRegion *mr;
     hwaddr addr;
     size_t len;
+    size_t size;    /* allocated size of buffer */
     uint8_t buffer[];
 } BounceBuffer;
 
+/*
+ * Bounce buffers are needed for every DMA to a non-direct region, so
+ * keep the last one released in each AddressSpace for the next mapping.
+ * The buffer is always returned zeroed: unmap copies back as many bytes
+ * as the device reports, which need not all have been written, and a
+ * failed read leaves the buffer untouched.  Neither may expose stale
+ * data to the guest.
+ */
+static BounceBuffer *bounce_buffer_alloc(AddressSpace *as, size_t len)
+{
+    BounceBuffer *bounce = qatomic_xchg(&as->bounce_buffer_cache, NULL);
+
+    if (bounce && bounce->size < len) {
+        g_free(bounce);
+        bounce = NULL;
+    }
+    if (!bounce) {
+        bounce = g_malloc0(len + sizeof(BounceBuffer));
+        bounce->size = len;
+    } else {
+        memset(bounce->buffer, 0, len);
+    }
+    return bounce;
+}
+
+static void bounce_buffer_free(AddressSpace *as, BounceBuffer *bounce)
+{
+    bounce->magic = ~BOUNCE_BUFFER_MAGIC;
+    bounce = qatomic_xchg(&as->bounce_buffer_cache, bounce);
+    g_free(bounce);
+}
+
 static void
 address_space_unregister_map_client_do(AddressSpaceMapClient *client)
 {
@@ -3721,7 +3775,7 @@ void *address_space_map(AddressSpace *as,
             return NULL;
         }
 
-        BounceBuffer *bounce = g_malloc0(l + sizeof(BounceBuffer));
+        BounceBuffer *bounce = bounce_buffer_alloc(as, l);
         bounce->magic = BOUNCE_BUFFER_MAGIC;
         memory_region_ref(mr);
         bounce->mr = mr;
@@ -3776,9 +3830,8 @@ void address_space_unmap(AddressSpace *as, void *buffer, hwaddr len,
     }
 
     qatomic_sub(&as->bounce_buffer_size, bounce->len);
-    bounce->magic = ~BOUNCE_BUFFER_MAGIC;
     memory_region_unref(bounce->mr);
-    g_free(bounce);
+    bounce_buffer_free(as, bounce);
     /* Write bounce_buffer_size before reading map_client_list. */
     smp_mb();
     address_space_notify_map_clients(as);
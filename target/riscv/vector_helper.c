@@ -274,13 +274,62 @@ static void vext_set_tail_elems_1s(target_ulong vl, void *vd,
     }
 }
 
+/*
+ * Return the host address for loading @esz bytes at @addr, or NULL
+ * if the element must be loaded through the TLB: MMIO, watchpoints,
+ * sub-page protection, or an element crossing a page boundary.
+ *
+ * The result of the last probe is cached in @page and @page_host, so
+ * that strided loads probe the TLB once per page rather than once per
+ * element.  Any fault is raised here, as the element load would.
+ */
+static void *vext_ld_elem_host(CPURISCVState *env, target_ulong addr,
+                               uint32_t esz, int mmu_index,
+                               target_ulong *page, void **page_host,
+                               uintptr_t ra)
+{
+    target_ulong offset = addr & ~TARGET_PAGE_MASK;
+
+    if (offset + esz > TARGET_PAGE_SIZE) {
+        return NULL;
+    }
+
+    if ((addr & TARGET_PAGE_MASK) != *page) {
+        void *host;
+        int flags;
+
+#ifdef CONFIG_USER_ONLY
+        flags = probe_access_flags(env, addr, esz, MMU_DATA_LOAD, mmu_index,
+                                   false, &host, ra);
+#else
+        CPUTLBEntryFull *full;
+
+        flags = probe_access_full(env, addr, esz, MMU_DATA_LOAD, mmu_index,
+                                  false, &host, &full, ra);
+        if (full->lg_page_size < TARGET_PAGE_BITS) {
+            /* e.g. PMP regions smaller than a page */
+            flags |= TLB_INVALID_MASK;
+        }
+#endif
+        *page = addr & TARGET_PAGE_MASK;
+        *page_host = flags == 0 ? host - offset : NULL;
+    }
+
+    return *page_host ? *page_host + offset : NULL;
+}
+
 /*
  * stride: access vector element from strided memory
+ *
+ * Loads pass @ld_host so that elements are read directly from host
+ * memory where possible; stores always go through the TLB, so that
+ * every element is checked for writes to translated code.
  */
 static void
 vext_ldst_stride(void *vd, void *v0, target_ulong base, target_ulong stride,
                  CPURISCVState *env, uint32_t desc, uint32_t vm,
-                 vext_ldst_elem_fn_tlb *ldst_elem, uint32_t log2_esz,
+                 vext_ldst_elem_fn_tlb *ldst_elem,
+                 vext_ldst_elem_fn_host *ld_host, uint32_t log2_esz,
                  uintptr_t ra)
 {
     uint32_t i, k;
@@ -288,6 +337,9 @@ vext_ldst_stride(void *vd, void *v0, target_ulong base, target_ulong stride,
     uint32_t max_elems = vext_max_elems(desc, log2_esz);
     uint32_t esz = 1 << log2_esz;
     uint32_t vma = vext_vma(desc);
+    int mmu_index = riscv_env_mmu_index(env, false);
+    target_ulong page = -1;
+    void *page_host = NULL;
 
     VSTART_CHECK_EARLY_EXIT(env, env->vl);
 
@@ -302,7 +354,19 @@ vext_ldst_stride(void *vd, void *v0, target_ulong base, target_ulong stride,
                 continue;
             }
             target_ulong addr = base + stride * i + (k << log2_esz);
-            ldst_elem(env, adjust_addr(env, addr), i + k * max_elems, vd, ra);
+            void *host = NULL;
+
+            addr = adjust_addr(env, addr);
+
+            if (ld_host) {
+                host = vext_ld_elem_host(env, addr, esz, mmu_index,
+                                         &page, &page_host, ra);
+            }
+            if (host) {
+                ld_host(vd, i + k * max_elems, host);
+            } else {
+                ldst_elem(env, addr, i + k * max_elems, vd, ra);
+            }
             k++;
         }
     }
@@ -311,20 +375,20 @@ vext_ldst_stride(void *vd, void *v0, target_ulong base, target_ulong stride,
     vext_set_tail_elems_1s(env->vl, vd, desc, nf, esz, max_elems);
 }
 
-#define GEN_VEXT_LD_STRIDE(NAME, ETYPE, LOAD_FN)                        \
+#define GEN_VEXT_LD_STRIDE(NAME, ETYPE, LOAD_FN, LOAD_FN_HOST)          \
 void HELPER(NAME)(void *vd, void * v0, target_ulong base,               \
                   target_ulong stride, CPURISCVState *env,              \
                   uint32_t desc)                                        \
 {                                                                       \
     uint32_t vm = vext_vm(desc);                                        \
     vext_ldst_stride(vd, v0, base, stride, env, desc, vm, LOAD_FN,      \
-                     ctzl(sizeof(ETYPE)), GETPC());                     \
+                     LOAD_FN_HOST, ctzl(sizeof(ETYPE)), GETPC());       \
 }
 
-GEN_VEXT_LD_STRIDE(vlse8_v,  int8_t,  lde_b_tlb)
-GEN_VEXT_LD_STRIDE(vlse16_v, int16_t, lde_h_tlb)
-GEN_VEXT_LD_STRIDE(vlse32_v, int32_t, lde_w_tlb)
-GEN_VEXT_LD_STRIDE(vlse64_v, int64_t, lde_d_tlb)
+GEN_VEXT_LD_STRIDE(vlse8_v,  int8_t,  lde_b_tlb, lde_b_host)
+GEN_VEXT_LD_STRIDE(vlse16_v, int16_t, lde_h_tlb, lde_h_host)
+GEN_VEXT_LD_STRIDE(vlse32_v, int32_t, lde_w_tlb, lde_w_host)
+GEN_VEXT_LD_STRIDE(vlse64_v, int64_t, lde_d_tlb, lde_d_host)
 
 #define GEN_VEXT_ST_STRIDE(NAME, ETYPE, STORE_FN)                       \
 void HELPER(NAME)(void *vd, void *v0, target_ulong base,                \
@@ -333,7 +397,7 @@ void HELPER(NAME)(void *vd, void *v0, target_ulong base,                \
 {                                                                       \
     uint32_t vm = vext_vm(desc);                                        \
     vext_ldst_stride(vd, v0, base, stride, env, desc, vm, STORE_FN,     \
-                     ctzl(sizeof(ETYPE)), GETPC());                     \
+                     NULL, ctzl(sizeof(ETYPE)), GETPC());               \
 }
 
 GEN_VEXT_ST_STRIDE(vsse8_v,  int8_t,  ste_b_tlb)
@@ -481,7 +545,8 @@ void HELPER(NAME##_mask)(void *vd, void *v0, target_ulong base,     \
 {                                                                   \
     uint32_t stride = vext_nf(desc) << ctzl(sizeof(ETYPE));         \
     vext_ldst_stride(vd, v0, base, stride, env, desc, false,        \
-                     LOAD_FN_TLB, ctzl(sizeof(ETYPE)), GETPC());    \
+                     LOAD_FN_TLB, LOAD_FN_HOST,                     \
+                     ctzl(sizeof(ETYPE)), GETPC());                 \
 }                                                                   \
                                                                     \
 void HELPER(NAME)(void *vd, void *v0, target_ulong base,            \
@@ -502,7 +567,7 @@ void HELPER(NAME##_mask)(void *vd, void *v0, target_ulong base,          \
 {                                                                        \
     uint32_t stride = vext_nf(desc) << ctzl(sizeof(ETYPE));              \
     vext_ldst_stride(vd, v0, base, stride, env, desc, false,             \
-                     STORE_FN_TLB, ctzl(sizeof(ETYPE)), GETPC());        \
+                     STORE_FN_TLB, NULL, ctzl(sizeof(ETYPE)), GETPC());  \
 }                                                                        \
                                                                          \
 void HELPER(NAME)(void *vd, void *v0, target_ulong base,                 \
@@ -45,8 +45,31 @@ typedef struct TempOptInfo {
     uint64_t z_mask;  /* mask bit is 0 if and only if value bit is 0 */
     uint64_t o_mask;  /* mask bit is 1 if and only if value bit is 1 */
     uint64_t s_mask;  /* mask bit is 1 if value bit matches msb */
+    unsigned version; /* incremented each time the temp is redefined */
 } TempOptInfo;
 
+/*
+ * Common subexpression elimination: a small direct-mapped table of
+ * recently computed side-effect free integer operations, keyed by
+ * opcode, type and inputs.  The version of each input and of the output
+ * is recorded, so that an entry is only used while none of those temps
+ * has been redefined.  Entries are valid only within the extended basic
+ * block in which they were recorded.
+ */
+#define CSE_TABLE_BITS  6
+#define CSE_MAX_ARGS    5
+
+typedef struct CSEEntry {
+    unsigned ebb;
+    TCGOpcode opc;
+    TCGType type;
+    unsigned nb_args;
+    TCGArg args[CSE_MAX_ARGS];
+    unsigned versions[CSE_MAX_ARGS];
+    TCGTemp *out;
+    unsigned out_version;
+} CSEEntry;
+
 typedef struct OptContext {
     TCGContext *tcg;
     TCGOp *prev_mb;
@@ -55,6 +78,10 @@ typedef struct OptContext {
     IntervalTreeRoot mem_copy;
     QSIMPLEQ_HEAD(, MemCopyInfo) mem_free;
 
+    CSEEntry *cse;
+    unsigned cse_ebb;
+    size_t cse_hits;
+
     /* In flight values from optimization. */
     TCGType type;
     int carry_state;  /* -1 = non-constant, {0,1} = constant carry-in */
@@ -137,6 +164,7 @@ static void init_ts_info(OptContext *ctx, TCGTemp *ts)
     if (ti == NULL) {
         ti = tcg_malloc(sizeof(TempOptInfo));
         ts->state_ptr = ti;
+        ti->version = 0;
     }
 
     ti->next_copy = ts;
@@ -237,6 +265,7 @@ static void reset_ts(OptContext *ctx, TCGTemp *ts)
     ti->z_mask = -1;
     ti->o_mask = 0;
     ti->s_mask = 0;
+    ti->version++;
 
     if (!QSIMPLEQ_EMPTY(&ti->mem_copy)) {
         if (ts == nts) {
@@ -859,6 +888,7 @@ static void finish_ebb(OptContext *ctx)
     /* We only optimize across extended basic blocks. */
     memset(&ctx->temps_used, 0, sizeof(ctx->temps_used));
     remove_mem_copy_all(ctx);
+    ctx->cse_ebb++;
 }
 
 static bool finish_folding(OptContext *ctx, TCGOp *op)
@@ -2730,7 +2760,7 @@ static bool fold_tcg_st(OptContext *ctx, TCGOp *op)
 
 static bool fold_tcg_st_memcopy(OptContext *ctx, TCGOp *op)
 {
-    TCGTemp *src;
+    TCGTemp *src, *prev;
     intptr_t ofs, last;
     TCGType type;
 
@@ -2743,15 +2773,16 @@ static bool fold_tcg_st_memcopy(OptContext *ctx, TCGOp *op)
     type = ctx->type;
 
     /*
-     * Eliminate duplicate stores of a constant.
-     * This happens frequently when the target ISA zero-extends.
+     * Eliminate stores of a value already known to be in memory.
+     * This happens frequently with duplicate stores of a constant when
+     * the target ISA zero-extends, and when a value loaded from env is
+     * written back unmodified, e.g. condition codes or a register that
+     * was only read by the insn.
      */
-    if (ts_is_const(src)) {
-        TCGTemp *prev = find_mem_copy_for(ctx, type, ofs);
-        if (src == prev) {
-            tcg_op_remove(ctx->tcg, op);
-            return true;
-        }
+    prev = find_mem_copy_for(ctx, type, ofs);
+    if (prev && ts_are_copies(src, prev)) {
+        tcg_op_remove(ctx->tcg, op);
+        return true;
     }
 
     last = ofs + tcg_type_size(type) - 1;
@@ -2782,14 +2813,123 @@ static bool fold_xor(OptContext *ctx, TCGOp *op)
     return fold_masks_zos(ctx, op, z_mask, o_mask, s_mask);
 }
 
+static bool cse_op_ok(TCGOpcode opc)
+{
+    switch (opc) {
+    case INDEX_op_add:
+    case INDEX_op_and:
+    case INDEX_op_andc:
+    case INDEX_op_bswap16:
+    case INDEX_op_bswap32:
+    case INDEX_op_bswap64:
+    case INDEX_op_clz:
+    case INDEX_op_ctpop:
+    case INDEX_op_ctz:
+    case INDEX_op_deposit:
+    case INDEX_op_divs:
+    case INDEX_op_divu:
+    case INDEX_op_eqv:
+    case INDEX_op_extract:
+    case INDEX_op_extract2:
+    case INDEX_op_movcond:
+    case INDEX_op_mul:
+    case INDEX_op_mulsh:
+    case INDEX_op_muluh:
+    case INDEX_op_nand:
+    case INDEX_op_neg:
+    case INDEX_op_negsetcond:
+    case INDEX_op_nor:
+    case INDEX_op_not:
+    case INDEX_op_or:
+    case INDEX_op_orc:
+    case INDEX_op_rems:
+    case INDEX_op_remu:
+    case INDEX_op_rotl:
+    case INDEX_op_rotr:
+    case INDEX_op_sar:
+    case INDEX_op_setcond:
+    case INDEX_op_sextract:
+    case INDEX_op_shl:
+    case INDEX_op_shr:
+    case INDEX_op_sub:
+    case INDEX_op_xor:
+    case INDEX_op_ext_i32_i64:
+    case INDEX_op_extu_i32_i64:
+    case INDEX_op_extrl_i64_i32:
+    case INDEX_op_extrh_i64_i32:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*
+ * Fill in @key from @op, whose inputs have already been copy propagated.
+ * Return the table slot for @op, or NULL if @op is not a candidate.
+ */
+static CSEEntry *cse_prepare(OptContext *ctx, TCGOp *op, CSEEntry *key)
+{
+    const TCGOpDef *def = &tcg_op_defs[op->opc];
+    unsigned nb_iargs = def->nb_iargs;
+    unsigned nb_args = nb_iargs + def->nb_cargs;
+    uint64_t h;
+    unsigned i;
+
+    if (!cse_op_ok(op->opc)) {
+        return NULL;
+    }
+    tcg_debug_assert(def->nb_oargs == 1);
+    tcg_debug_assert(nb_args <= CSE_MAX_ARGS);
+
+    key->ebb = ctx->cse_ebb;
+    key->opc = op->opc;
+    key->type = ctx->type;
+    key->nb_args = nb_args;
+    key->out = arg_temp(op->args[0]);
+
+    h = op->opc * 31 + ctx->type;
+    for (i = 0; i < nb_args; i++) {
+        TCGArg arg = op->args[1 + i];
+
+        key->args[i] = arg;
+        key->versions[i] = i < nb_iargs ? arg_info(arg)->version : 0;
+        h = h * 31 + arg;
+    }
+    h *= 0x9e3779b97f4a7c15ull;
+    return &ctx->cse[h >> (64 - CSE_TABLE_BITS)];
+}
+
+static bool cse_match(const CSEEntry *e, const CSEEntry *key)
+{
+    unsigned i;
+
+    if (e->ebb != key->ebb || e->opc != key->opc || e->type != key->type) {
+        return false;
+    }
+    /* The earlier output must still hold the computed value. */
+    if (ts_info(e->out)->version != e->out_version) {
+        return false;
+    }
+    for (i = 0; i < key->nb_args; i++) {
+        if (e->args[i] != key->args[i] || e->versions[i] != key->versions[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /* Propagate constants and copies, fold constant expressions. */
 void tcg_optimize(TCGContext *s)
 {
     int nb_temps, i;
     TCGOp *op, *op_next;
     OptContext ctx = { .tcg = s };
+    int nb_ops = s->nb_ops;
 
     QSIMPLEQ_INIT(&ctx.mem_free);
+    ctx.cse = tcg_malloc(sizeof(CSEEntry) << CSE_TABLE_BITS);
+    memset(ctx.cse, 0, sizeof(CSEEntry) << CSE_TABLE_BITS);
+    ctx.cse_ebb = 1;
 
     /* Array VALS has an element for each temp.
        If this temp holds a constant then its value is kept in VALS' element.
@@ -2804,6 +2944,7 @@ void tcg_optimize(TCGContext *s)
     QTAILQ_FOREACH_SAFE(op, &s->ops, link, op_next) {
         TCGOpcode opc = op->opc;
         const TCGOpDef *def;
+        CSEEntry cse_key, *cse_slot;
         bool done = false;
 
         /* Calls are special. */
@@ -2819,6 +2960,14 @@ void tcg_optimize(TCGContext *s)
         /* Pre-compute the type of the operation. */
         ctx.type = TCGOP_TYPE(op);
 
+        /* Reuse the result of an identical earlier computation. */
+        cse_slot = cse_prepare(&ctx, op, &cse_key);
+        if (cse_slot && cse_match(cse_slot, &cse_key)) {
+            ctx.cse_hits++;
+            tcg_opt_gen_mov(&ctx, op, op->args[0], temp_arg(cse_slot->out));
+            continue;
+        }
+
         /*
          * Process each opcode.
          * Sorted alphabetically by opcode as much as possible.
@@ -3026,5 +3175,34 @@ void tcg_optimize(TCGContext *s)
             break;
         }
         tcg_debug_assert(done);
+
+        if (cse_slot) {
+            cse_key.out_version = ts_info(cse_key.out)->version;
+            *cse_slot = cse_key;
+        }
+    }
+
+    qatomic_set(&s->opt_ops_in, s->opt_ops_in + nb_ops);
+    qatomic_set(&s->opt_ops_out, s->opt_ops_out + s->nb_ops);
+    qatomic_set(&s->opt_cse_count, s->opt_cse_count + ctx.cse_hits);
+}
+
+/*
+ * Sum the optimizer statistics of all TCG contexts.
+ * Like tcg_code_size(), this may race with translation and is
+ * only meant for reporting.
+ */
+void tcg_optimize_stats(size_t *ops_in, size_t *ops_out, size_t *cse)
+{
+    unsigned int n_ctxs = qatomic_read(&tcg_cur_ctxs);
+    unsigned int i;
+
+    *ops_in = *ops_out = *cse = 0;
+    for (i = 0; i < n_ctxs; i++) {
+        const TCGContext *s = qatomic_read(&tcg_ctxs[i]);
+
+        *ops_in += qatomic_read(&s->opt_ops_in);
+        *ops_out += qatomic_read(&s->opt_ops_out);
+        *cse += qatomic_read(&s->opt_cse_count);
     }
 }
@@ -4623,6 +4623,13 @@ static void tcg_reg_free(TCGContext *s, TCGReg reg, TCGRegSet allocated_regs)
     }
 }
 
+/* Return true if freeing 'reg' does not require a store to memory. */
+static bool tcg_reg_spill_free(TCGContext *s, TCGReg reg)
+{
+    TCGTemp *ts = s->reg_to_temp[reg];
+    return temp_readonly(ts) || ts->mem_coherent;
+}
+
 /**
  * tcg_reg_alloc:
  * @required_regs: Set of registers in which we must allocate.
@@ -4672,7 +4679,23 @@ static TCGReg tcg_reg_alloc(TCGContext *s, TCGRegSet required_regs,
         }
     }
 
-    /* We must spill something.  */
+    /*
+     * We must spill something.  Prefer a register whose contents need
+     * not be stored first: a constant, which can be rematerialized, or
+     * a value that is already coherent with its memory slot.
+     */
+    for (j = f; j < 2; j++) {
+        TCGRegSet set = reg_ct[j];
+
+        for (i = 0; i < n; i++) {
+            TCGReg reg = order[i];
+            if (tcg_regset_test_reg(set, reg) && tcg_reg_spill_free(s, reg)) {
+                tcg_reg_free(s, reg, allocated_regs);
+                return reg;
+            }
+        }
+    }
+
     for (j = f; j < 2; j++) {
         TCGRegSet set = reg_ct[j];
 
@@ -164,6 +164,31 @@ static void test_multifd_tcp_zlib(char *name, MigrateCommon *args)
     test_precopy_common(args);
 }
 
+static void *
+migrate_hook_start_precopy_tcp_multifd_delta(QTestState *from,
+                                             QTestState *to)
+{
+    migrate_set_parameter_int(from, "xbzrle-cache-size", 33554432);
+
+    return migrate_hook_start_precopy_tcp_multifd_common(from, to, "delta");
+}
+
+static void test_multifd_tcp_delta(char *name, MigrateCommon *args)
+{
+    args->listen_uri = "defer";
+    args->start_hook = migrate_hook_start_precopy_tcp_multifd_delta;
+    args->iterations = 2;
+    /*
+     * Deltas are only sent for pages that were already sent once, so
+     * pages need to be modified during the 2nd+ round.
+     */
+    args->live = true;
+
+    args->start.caps[MIGRATION_CAPABILITY_MULTIFD] = true;
+
+    test_precopy_common(args);
+}
+
 static void migration_test_add_compression_smoke(MigrationTestEnv *env)
 {
     migration_test_add("/migration/multifd/tcp/plain/zlib",
@@ -180,6 +205,9 @@ void migration_test_add_compression(MigrationTestEnv *env)
         return;
     }
 
+    migration_test_add("/migration/multifd/tcp/plain/delta",
+                       test_multifd_tcp_delta);
+
 #ifdef CONFIG_ZSTD
     migration_test_add("/migration/multifd/tcp/plain/zstd",
                        test_multifd_tcp_zstd);
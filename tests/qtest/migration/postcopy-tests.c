@@ -39,6 +39,21 @@ static void test_postcopy_preempt(char *name, MigrateCommon *args)
     test_postcopy_common(args);
 }
 
+static void test_postcopy_fault_ahead(char *name, MigrateCommon *args)
+{
+    args->start.caps[MIGRATION_CAPABILITY_X_POSTCOPY_FAULT_AHEAD] = true;
+
+    test_postcopy_common(args);
+}
+
+static void test_postcopy_preempt_fault_ahead(char *name, MigrateCommon *args)
+{
+    args->start.caps[MIGRATION_CAPABILITY_POSTCOPY_PREEMPT] = true;
+    args->start.caps[MIGRATION_CAPABILITY_X_POSTCOPY_FAULT_AHEAD] = true;
+
+    test_postcopy_common(args);
+}
+
 static void test_postcopy_recovery(char *name, MigrateCommon *args)
 {
     test_postcopy_recovery_common(args, POSTCOPY_FAIL_NONE);
@@ -109,6 +124,11 @@ void migration_test_add_postcopy(MigrationTestEnv *env)
             "/migration/postcopy/recovery/double-failures/reconnect",
             test_postcopy_recovery_fail_reconnect);
 
+        migration_test_add("/migration/postcopy/fault-ahead/plain",
+                           test_postcopy_fault_ahead);
+        migration_test_add("/migration/postcopy/fault-ahead/preempt",
+                           test_postcopy_preempt_fault_ahead);
+
         migration_test_add("/migration/multifd+postcopy/plain",
                            test_multifd_postcopy);
         migration_test_add("/migration/multifd+postcopy/preempt/plain",
@@ -449,6 +449,32 @@ static void test_multifd_tcp_uri_none(char *name, MigrateCommon *args)
     test_precopy_common(args);
 }
 
+static void test_precopy_unix_defer_hot_pages(char *name, MigrateCommon *args)
+{
+    g_autofree char *uri = g_strdup_printf("unix:%s/migsocket", tmpfs);
+
+    args->listen_uri = uri;
+    args->connect_uri = uri;
+    /* The guest keeps writing memory, so some pages are hot every round */
+    args->live = true;
+
+    args->start.caps[MIGRATION_CAPABILITY_X_DEFER_HOT_PAGES] = true;
+
+    test_precopy_common(args);
+}
+
+static void test_multifd_tcp_defer_hot_pages(char *name, MigrateCommon *args)
+{
+    args->listen_uri = "defer";
+    args->start_hook = migrate_hook_start_precopy_tcp_multifd;
+    args->live = true;
+
+    args->start.caps[MIGRATION_CAPABILITY_MULTIFD] = true;
+    args->start.caps[MIGRATION_CAPABILITY_X_DEFER_HOT_PAGES] = true;
+
+    test_precopy_common(args);
+}
+
 static void test_multifd_tcp_zero_page_legacy(char *name, MigrateCommon *args)
 {
     args->listen_uri = "defer";
@@ -1212,6 +1238,10 @@ void migration_test_add_precopy(MigrationTestEnv *env)
 
     migration_test_add("/migration/precopy/tcp/plain/switchover-ack",
                        test_precopy_tcp_switchover_ack);
+    migration_test_add("/migration/precopy/unix/defer-hot-pages",
+                       test_precopy_unix_defer_hot_pages);
+    migration_test_add("/migration/multifd/tcp/plain/defer-hot-pages",
+                       test_multifd_tcp_defer_hot_pages);
 
 #ifndef _WIN32
     migration_test_add("/migration/precopy/fd/tcp",
@@ -0,0 +1,119 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Remap 2M pages mapped in the upper half of the address space and check
+ * that invlpg makes the new mapping visible.  The two aliases used here
+ * merge into the large page region 0xffff800000000000, which contains
+ * the -1 comparators of unused tlb entries; flushing it must only drop
+ * the entries that are really within the region.
+ */
+#include <stdint.h>
+#include <minilib.h>
+
+#define PG_PRESENT  (1ull << 0)
+#define PG_RW       (1ull << 1)
+#define PG_PSE      (1ull << 7)
+
+#define LARGE_PAGE  (2ull << 20)
+
+/* Physical 2M frames below 128M, not used by the test kernel */
+#define PHYS_A      (32ull << 20)
+#define PHYS_B      (34ull << 20)
+
+/* Linux-style direct map and top of the address space */
+#define HI_DIRECT   0xffff888000000000ull
+#define HI_TOP      0xffffff8000000000ull
+
+static uint64_t pdp_hi[512] __attribute__((aligned(4096)));
+static uint64_t pd_hi[512] __attribute__((aligned(4096)));
+
+static inline uint64_t read_cr3(void)
+{
+    uint64_t val;
+
+    asm volatile("mov %%cr3, %0" : "=r"(val));
+    return val;
+}
+
+static inline void write_cr3(uint64_t val)
+{
+    asm volatile("mov %0, %%cr3" : : "r"(val) : "memory");
+}
+
+static inline void invlpg(uint64_t addr)
+{
+    asm volatile("invlpg (%0)" : : "r"(addr) : "memory");
+}
+
+static inline uint64_t peek(uint64_t addr)
+{
+    return *(volatile uint64_t *)addr;
+}
+
+static inline void poke(uint64_t addr, uint64_t val)
+{
+    *(volatile uint64_t *)addr = val;
+}
+
+static int check(const char *what, uint64_t addr, uint64_t expected)
+{
+    uint64_t val = peek(addr);
+
+    if (val != expected) {
+        ml_printf("FAIL: %s: %lx read %lx, expected %lx\n",
+                  what, addr, val, expected);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    uint64_t *pml4 = (uint64_t *)(read_cr3() & ~0xfffull);
+    int err = 0;
+    int i;
+
+    /* The low 4G are identity mapped, so physical == virtual here */
+    poke(PHYS_A, 0xaaaa);
+    poke(PHYS_B, 0xbbbb);
+
+    pd_hi[0] = PHYS_A | PG_PSE | PG_RW | PG_PRESENT;
+    pd_hi[1] = PHYS_B | PG_PSE | PG_RW | PG_PRESENT;
+    pdp_hi[0] = (uint64_t)pd_hi | PG_RW | PG_PRESENT;
+    pml4[(HI_DIRECT >> 39) & 511] = (uint64_t)pdp_hi | PG_RW | PG_PRESENT;
+    pml4[(HI_TOP >> 39) & 511] = (uint64_t)pdp_hi | PG_RW | PG_PRESENT;
+    write_cr3(read_cr3());
+
+    for (i = 0; i < 16; i++) {
+        uint64_t first = i & 1 ? PHYS_B : PHYS_A;
+        uint64_t other = i & 1 ? PHYS_A : PHYS_B;
+        uint64_t first_val = i & 1 ? 0xbbbb : 0xaaaa;
+        uint64_t other_val = i & 1 ? 0xaaaa : 0xbbbb;
+
+        err |= check("direct map", HI_DIRECT, first_val);
+        err |= check("top", HI_TOP, first_val);
+        err |= check("direct map + 2M", HI_DIRECT + LARGE_PAGE, other_val);
+
+        /* Swap the two frames and flush one page of each alias */
+        pd_hi[0] = other | PG_PSE | PG_RW | PG_PRESENT;
+        pd_hi[1] = first | PG_PSE | PG_RW | PG_PRESENT;
+        invlpg(HI_DIRECT);
+        invlpg(HI_TOP);
+        invlpg(HI_DIRECT + LARGE_PAGE);
+        invlpg(HI_TOP + LARGE_PAGE);
+
+        err |= check("remapped direct map", HI_DIRECT, other_val);
+        err |= check("remapped top", HI_TOP, other_val);
+        err |= check("remapped top + 2M", HI_TOP + LARGE_PAGE, first_val);
+
+        /* Writes through the new mapping land in the new frame */
+        poke(HI_DIRECT + 8, i);
+        err |= check("low alias", other + 8, i);
+        if (err) {
+            break;
+        }
+    }
+
+    ml_printf("%s\n", err ? "FAIL" : "PASS");
+    return err;
+}
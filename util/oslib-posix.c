@@ -62,6 +62,8 @@
 #include "qemu/mmap-alloc.h"
 
 #define MAX_MEM_PREALLOC_THREAD_COUNT 16
+/* Unit of work handed out to MADV_POPULATE_WRITE preallocation threads. */
+#define MEM_PREALLOC_CHUNK_SIZE (256 * MiB)
 
 struct MemsetThread;
 
@@ -73,6 +75,11 @@ typedef struct MemsetContext {
     bool any_thread_failed;
     struct MemsetThread *threads;
     int num_threads;
+    /* Area shared by all threads when using MADV_POPULATE_WRITE */
+    char *area;
+    size_t numpages;
+    size_t hpagesize;
+    size_t next_page;
     QLIST_ENTRY(MemsetContext) next;
 } MemsetContext;
 
@@ -420,11 +427,17 @@ static void *do_touch_pages(void *arg)
     return (void *)(uintptr_t)ret;
 }
 
+/*
+ * Threads populate the area in chunks taken from a shared cursor, rather
+ * than in fixed slices, so that threads which are slower (e.g. because
+ * their CPU is busy or the memory is on a remote node) do less of the work.
+ */
 static void *do_madv_populate_write_pages(void *arg)
 {
     MemsetThread *memset_args = (MemsetThread *)arg;
-    const size_t size = memset_args->numpages * memset_args->hpagesize;
-    char * const addr = memset_args->addr;
+    MemsetContext *context = memset_args->context;
+    const size_t hpagesize = context->hpagesize;
+    const size_t chunk_pages = MAX(1, MEM_PREALLOC_CHUNK_SIZE / hpagesize);
     int ret = 0;
 
     /* See do_touch_pages(). */
@@ -434,8 +447,19 @@ static void *do_madv_populate_write_pages(void *arg)
     }
     qemu_mutex_unlock(&page_mutex);
 
-    if (size && qemu_madvise(addr, size, QEMU_MADV_POPULATE_WRITE)) {
-        ret = -errno;
+    while (true) {
+        size_t first = qatomic_fetch_add(&context->next_page, chunk_pages);
+        size_t n;
+
+        if (first >= context->numpages) {
+            break;
+        }
+        n = MIN(chunk_pages, context->numpages - first);
+        if (qemu_madvise(context->area + first * hpagesize, n * hpagesize,
+                         QEMU_MADV_POPULATE_WRITE)) {
+            ret = -errno;
+            break;
+        }
     }
     return (void *)(uintptr_t)ret;
 }
@@ -496,6 +520,9 @@ static int touch_all_pages(char *area, size_t hpagesize, size_t numpages,
 
     context->num_threads =
         get_memset_num_threads(hpagesize, numpages, max_threads);
+    context->area = area;
+    context->numpages = numpages;
+    context->hpagesize = hpagesize;
 
     if (g_once_init_enter(&initialized)) {
         qemu_mutex_init(&page_mutex);